@@ -0,0 +1,231 @@
+/* Thread placement for multi-threaded runs: worker threads are pinned to cpus, each worker creates its own solver
+ * after it is pinned so that the swarm state is placed on its node by first touch, and the read only prepared
+ * instance can be copied once per node. The topology is read from sysfs, a machine without it is one node.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include "aff.h"
+
+vector<int> rdCpus(string fn)
+/* Reads a cpu list file (e.g. 0-3,8-11), tokens that do not parse are skipped. */
+{
+    ifstream fs;
+    vector<int> c;
+    string s, t;
+    size_t p, d;
+    int a, b, i, k;
+    fs.open(fn);
+    if (!(fs >> s))
+        return c;
+    p = 0;
+    while (p < s.size())
+    {
+        d = s.find(',', p);
+        t = s.substr(p, d == string::npos ? string::npos : d - p);
+        p = d == string::npos ? s.size() : d + 1;
+        a = -1;
+        b = -1;
+        k = sscanf(t.c_str(), "%d-%d", &a, &b);
+        if (k == 1)
+            b = a;
+        else if (k != 2)
+            continue;
+        for (i = max(a, 0); i <= b; i++)
+            c.push_back(i);
+    }
+    return c;
+}
+
+Topo::Topo()
+/* Reads the nodes and their cpus, keeping the cpus in the affinity mask of the process. */
+{
+    cpu_set_t cs;
+    DIR *dir;
+    dirent *pdir;
+    vector<int> nds, c;
+    string str;
+    int i, k;
+    CPU_ZERO(&cs);
+    sched_getaffinity(0, sizeof(cs), &cs);
+    nn = 0;
+    dir = opendir(AFF_SYS);
+    if (dir != NULL)
+    {
+        while ((pdir = readdir(dir)) != NULL)
+        {
+            str = pdir->d_name;
+            if (str.size() > 4 && str.compare(0, 4, "node") == 0 && isdigit(str[4]))
+                nds.push_back(atoi(str.c_str() + 4));
+        }
+        closedir(dir);
+    }
+    sort(nds.begin(), nds.end());
+    for (k = 0; k < (int)nds.size(); k++)
+    {
+        c = rdCpus(string(AFF_SYS) + "/node" + to_string(nds[k]) + "/cpulist");
+        for (i = 0; i < (int)c.size(); i++)
+            if (c[i] < CPU_SETSIZE && CPU_ISSET(c[i], &cs))
+            {
+                cpus.push_back(c[i]);
+                nd.push_back(nn);
+            }
+        if ((int)nd.size() > 0 && nd.back() == nn)
+            nn++;
+    }
+    if (cpus.size() == 0)
+    {
+        for (i = 0; i < CPU_SETSIZE; i++)
+            if (CPU_ISSET(i, &cs))
+            {
+                cpus.push_back(i);
+                nd.push_back(0);
+            }
+        nn = 1;
+    }
+}
+
+Aff::Aff(int pol0, bool rpl0)
+{
+    vector<vector<int> > bn;
+    int i, k;
+    pol = pol0;
+    rpl = rpl0;
+    bn.resize(tp.nn);
+    for (i = 0; i < (int)tp.cpus.size(); i++)
+        bn[tp.nd[i]].push_back(i);
+    if (pol == AFF_SCT)
+        for (k = 0; (int)ord.size() < (int)tp.cpus.size(); k++)
+        {
+            for (i = 0; i < tp.nn; i++)
+                if (k < (int)bn[i].size())
+                    ord.push_back(bn[i][k]);
+        }
+    else
+        for (i = 0; i < (int)tp.cpus.size(); i++)
+            ord.push_back(i);
+}
+
+int Aff::pin(int w)
+/* Pins the calling thread, worker w, to its cpu, returns the cpu (-1 if not pinned). */
+{
+    cpu_set_t cs;
+    int c;
+    if (pol == AFF_NON)
+        return -1;
+    c = tp.cpus[ord[w % ord.size()]];
+    CPU_ZERO(&cs);
+    CPU_SET(c, &cs);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs) != 0)
+        return -1;
+    return c;
+}
+
+int Aff::node(int w)
+/* Returns the node of worker w (of the cpu the calling thread is on if the workers are not pinned). */
+{
+    int c, i;
+    if (pol != AFF_NON)
+        return tp.nd[ord[w % ord.size()]];
+    c = sched_getcpu();
+    for (i = 0; i < (int)tp.cpus.size(); i++)
+        if (tp.cpus[i] == c)
+            return tp.nd[i];
+    return 0;
+}
+
+MdKPVS Aff::rep(int w, MdKPVS pv0)
+/* Returns the replica of a prepared instance on the node of worker w (pv0 itself if there are no replicas), to be
+ * called by worker w so that a new replica is first touched on its node.
+*/
+{
+    vector<MdKPVS> *r;
+    int n;
+    if (!rpl || tp.nn < 2 || pv0 == nullptr)
+        return pv0;
+    n = node(w);
+    lock_guard<mutex> lck(mtx);
+    r = &pv[pv0];
+    if (r->size() == 0)
+        r->resize(tp.nn);
+    if ((*r)[n] == nullptr)
+        (*r)[n] = make_shared<MdKPV>(*pv0);
+    return (*r)[n];
+}
+
+bool scl(string fn, const Prm &prm, int rns, int thr, int pol, bool rpl, string &err)
+/* Measures the throughput of runs on 1, 2, 4, ... and thr threads, each thread does rns runs of the problem in
+ * fn with its own solver, and outputs the speed up and the efficiency over one thread.
+*/
+{
+    vector<thread> wks;
+    vector<int> ts;
+    MdKPS mdkp;
+    MdKPQ pq;
+    MdKPVS pv;
+    Prm p0;
+    tm_pt t0;
+    double tm, rps, rps1;
+    int t, w;
+    mdkp = ldPrb(fn, err);
+    if (mdkp == nullptr)
+        return false;
+    if (rns < 1 || thr < 1)
+    {
+        err = "bad scaling parameters";
+        return false;
+    }
+    p0 = prm;
+    p0.mx = 0;
+    p0.ckp = "";
+    pq.ini(p0);
+    pq.slv(mdkp);
+    pv = pq.prp;
+    for (t = 1; t < thr; t *= 2)
+        ts.push_back(t);
+    ts.push_back(thr);
+    Aff af(pol, rpl);
+    cout << fixed << setprecision(AFF_PREC);
+    cout << "scaling " << fn << ", rns = " << rns << " per thread, nodes = " << af.tp.nn << ", cpus = "
+        << af.tp.cpus.size() << ", aff = " << pol << ", rpl = " << rpl << endl;
+    rps1 = 0;
+    for (t = 0; t < (int)ts.size(); t++)
+    {
+        wks.clear();
+        t0 = timer::now();
+        for (w = 0; w < ts[t]; w++)
+            wks.push_back(thread([&, w]()
+            {
+                int r;
+                af.pin(w);
+                // made after the pin so that the swarm state is placed on the node of the thread
+                MdKPQ sq;
+                Prm p;
+                p = prm;
+                p.ckp = "";
+                for (r = 0; r < rns; r++)
+                {
+                    p.se = prm.se + w*rns + r;
+                    sq.ini(p);
+                    sq.prp = af.rep(w, pv);
+                    sq.slv(mdkp);
+                }
+            }));
+        for (w = 0; w < ts[t]; w++)
+            wks[w].join();
+        tm = calcMsD(timer::now() - t0);
+        rps = ts[t]*rns/(tm/1000);
+        if (t == 0)
+            rps1 = rps;
+        cout << "thr = " << ts[t] << ", tm = " << tm << " ms, runs/s = " << rps << ", speed up = " << rps/rps1
+            << ", eff = " << 100*rps/rps1/ts[t] << " %" << endl;
+    }
+    return true;
+}
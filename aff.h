@@ -0,0 +1,54 @@
+#ifndef AFF_H
+#define AFF_H
+
+#include <mutex>
+#include <map>
+#include "mdkp.h"
+
+#define AFF_NON 0
+#define AFF_CMP 1
+#define AFF_SCT 2
+#define AFF_SYS "/sys/devices/system/node"
+#define AFF_PREC 2
+
+struct Topo
+/* Processor topology of the cpus the process may run on:
+ * cpus = cpu numbers, grouped by node,
+ * nd = node (numbered from 0 in the order found) of each entry of cpus,
+ * nn = number of nodes.
+*/
+{
+    vector<int> cpus, nd;
+    int nn;
+    Topo();
+};
+
+class Aff
+/* Placement of worker threads:
+ * pol = policy (AFF_NON none, AFF_CMP pin worker w to the w-th cpu so the nodes fill one by one, AFF_SCT pin the
+ * workers to the nodes in turn),
+ * rpl = true to give each node its own copy of the read only prepared instance,
+ * tp = topology,
+ * ord = entries of tp.cpus in the order the workers are pinned to them,
+ * pv = replicas of each prepared instance, one per node (made on first use by a thread on the node, so that its
+ * pages are placed there by first touch), kept for as long as the placement so an instance is copied once per node,
+ * mtx = serialises pv.
+*/
+{
+public:
+    int pol;
+    bool rpl;
+    Topo tp;
+    Aff(int pol0, bool rpl0);
+    int pin(int w);
+    int node(int w);
+    MdKPVS rep(int w, MdKPVS pv0);
+private:
+    vector<int> ord;
+    map<MdKPVS, vector<MdKPVS> > pv;
+    mutex mtx;
+};
+
+bool scl(string fn, const Prm &prm, int rns, int thr, int pol, bool rpl, string &err);
+
+#endif
@@ -0,0 +1,194 @@
+/* Binary cache of prepared instances: an entry holds the raw arrays of a problem together with its utility
+ * permutation, the duals and the LP bound, it is named after the content hash of the source file so a changed
+ * source misses the cache and gets a new entry, and it is loaded with mmap straight into the problem and view
+ * without parsing or solving the LP.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cch.h"
+
+class MMap
+/* Read only memory map of a file:
+ * p = start of the map (null if the file could not be mapped),
+ * sz = size of the file.
+*/
+{
+public:
+    const char *p;
+    size_t sz;
+    MMap(string fn);
+    ~MMap();
+};
+
+MMap::MMap(string fn)
+{
+    struct stat st;
+    void *m;
+    int fd;
+    p = nullptr;
+    sz = 0;
+    fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED)
+        {
+            p = (const char *)m;
+            sz = st.st_size;
+        }
+    }
+    close(fd);
+}
+
+MMap::~MMap()
+{
+    if (p != nullptr)
+        munmap((void *)p, sz);
+}
+
+uint64_t hshB(const char *p, size_t n)
+/* Returns the FNV-1a hash of n bytes. */
+{
+    uint64_t h;
+    size_t k;
+    h = 0xcbf29ce484222325ull;
+    for (k = 0; k < n; k++)
+        h = (h ^ (unsigned char)p[k])*0x100000001b3ull;
+    return h;
+}
+
+size_t cchSz(int itms, int dims)
+/* Returns the size of a cache file. */
+{
+    return sizeof(CchH) + (itms + itms*dims + dims + itms)*sizeof(int32_t) + dims*sizeof(double);
+}
+
+bool prmOk(const int32_t a[], int n)
+/* Returns true if a holds a permutation of 0 .. n - 1. */
+{
+    vector<bool> sn(n, false);
+    int j;
+    for (j = 0; j < n; j++)
+    {
+        if (a[j] < 0 || a[j] >= n || sn[a[j]])
+            return false;
+        sn[a[j]] = true;
+    }
+    return true;
+}
+
+MdKPVS ldCch(string fn, string cdn, int lpm, CchK &ck, string &err)
+/* Looks a source file up in the cache directory cdn, returns the prepared view (its src is the problem) if the
+ * entry is valid, else null with ck set for wrCch (ck.fn is empty if the source cannot be read), an entry whose
+ * order is not a permutation of the items or whose duals are not finite is a miss (so it is rebuilt).
+*/
+{
+    shared_ptr<MdKP> prb;
+    shared_ptr<MdKPV> vw;
+    const CchH *h;
+    const int32_t *a;
+    vector<double> dl;
+    char hx[17];
+    int i;
+    ck.fn = "";
+    {
+        MMap sm(fn);
+        if (sm.p == nullptr)
+            return nullptr;
+        ck.hsh = hshB(sm.p, sm.sz);
+        ck.sz = sm.sz;
+    }
+    ck.lpm = lpm;
+    snprintf(hx, sizeof(hx), "%016llx", (unsigned long long)ck.hsh);
+    ck.fn = cdn + "/" + hx + "." + to_string(lpm) + CCH_EXT;
+    MMap cm(ck.fn);
+    if (cm.p == nullptr || cm.sz < sizeof(CchH))
+        return nullptr;
+    h = (const CchH *)cm.p;
+    if (h->mag != CCH_MAG || h->ver != CCH_VER || h->hsh != ck.hsh || h->sz != ck.sz || h->lpm != lpm
+        || h->itms < 1 || h->itms > N_MX || h->dims < 1 || h->dims > M_MX || cm.sz != cchSz(h->itms, h->dims))
+        return nullptr;
+    a = (const int32_t *)(cm.p + sizeof(CchH));
+    prb = make_shared<MdKP>();
+    if (!prb->mkPrb(h->itms, h->dims, a, a + h->itms, a + h->itms + h->itms*h->dims, h->opt))
+    {
+        err = prb->err;
+        return nullptr;
+    }
+    prb->pfn = fn;
+    a += h->itms + h->itms*h->dims + h->dims;
+    if (!prmOk(a, h->itms))
+        return nullptr;
+    dl.resize(h->dims);
+    memcpy(dl.data(), a + h->itms, h->dims*sizeof(double));
+    for (i = 0; i < h->dims; i++)
+        if (!isfinite(dl[i]))
+            return nullptr;
+    vw = make_shared<MdKPV>(prb, a);
+    vw->dl = dl;
+    vw->lpm = lpm;
+    vw->lps.mth = h->mth;
+    vw->lps.its = h->its;
+    vw->lps.tb = h->tb;
+    vw->lps.ts = h->ts;
+    vw->lps.z = h->z;
+    return vw;
+}
+
+bool wrCch(const CchK &ck, MdKPVS pv, string &err)
+/* Writes a cache entry for a prepared view, to a temporary file renamed into place. */
+{
+    CchH h;
+    vector<int32_t> a;
+    const MdKP *src;
+    FILE *fp;
+    string tfn;
+    bool ok;
+    int i;
+    src = pv->src.get();
+    if ((int)pv->dl.size() != src->dims)
+    {
+        err = "no duals to cache for " + src->pfn + ".";
+        return false;
+    }
+    memset(&h, 0, sizeof(h));
+    h.mag = CCH_MAG;
+    h.ver = CCH_VER;
+    h.hsh = ck.hsh;
+    h.sz = ck.sz;
+    h.lpm = ck.lpm;
+    h.itms = src->itms;
+    h.dims = src->dims;
+    h.opt = src->opt;
+    h.mth = pv->lps.mth;
+    h.its = pv->lps.its;
+    h.tb = pv->lps.tb;
+    h.ts = pv->lps.ts;
+    h.z = pv->lps.z;
+    a.assign(src->val, src->val + src->itms);
+    for (i = 0; i < src->dims; i++)
+        a.insert(a.end(), src->wei[i], src->wei[i] + src->itms);
+    a.insert(a.end(), src->cap, src->cap + src->dims);
+    a.insert(a.end(), pv->idx.begin(), pv->idx.end());
+    tfn = ck.fn + ".tmp";
+    fp = fopen(tfn.c_str(), "wb");
+    ok = fp != NULL;
+    if (ok)
+    {
+        ok = fwrite(&h, sizeof(h), 1, fp) == 1 && fwrite(a.data(), sizeof(int32_t), a.size(), fp) == a.size()
+            && fwrite(pv->dl.data(), sizeof(double), src->dims, fp) == (size_t)src->dims;
+        ok = fclose(fp) == 0 && ok;
+    }
+    ok = ok && rename(tfn.c_str(), ck.fn.c_str()) == 0;
+    if (!ok)
+        err = "Error writing cache " + ck.fn + ".";
+    return ok;
+}
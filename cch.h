@@ -0,0 +1,35 @@
+#include "mdkp.h"
+
+#define CCH_MAG 0x4843514d
+#define CCH_VER 1
+#define CCH_EXT ".mqc"
+
+struct CchK
+/* Key of a cache entry:
+ * fn = cache file (empty if the source cannot be cached),
+ * hsh = content hash (FNV-1a) of the source file,
+ * sz = size of the source file,
+ * lpm = linear relaxation method the view was prepared with.
+*/
+{
+    string fn;
+    uint64_t hsh, sz;
+    int lpm;
+};
+
+struct CchH
+/* Header of a cache file, followed by val (itms), wei (row major, dims*itms), cap (dims), idx (itms) and dl (dims):
+ * mag, ver = magic number and version,
+ * hsh, sz, lpm = key,
+ * itms, dims, opt = problem sizes and optimum value,
+ * mth, its, tb, ts, z = LP statistics.
+*/
+{
+    uint32_t mag, ver;
+    uint64_t hsh, sz;
+    int32_t lpm, itms, dims, opt, mth, its;
+    double tb, ts, z;
+};
+
+MdKPVS ldCch(string fn, string cdn, int lpm, CchK &ck, string &err);
+bool wrCch(const CchK &ck, MdKPVS pv, string &err);
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <algorithm>
+#include "ckp.h"
+
+Ckp::Ckp(string fn0)
+{
+    fn = fn0;
+    pnd = false;
+    end = false;
+    th = thread(&Ckp::wrk, this);
+}
+
+Ckp::~Ckp()
+{
+    cls();
+}
+
+void Ckp::cls()
+/* Writes the pending image and stops the thread. */
+{
+    if (!th.joinable())
+        return;
+    {
+        lock_guard<mutex> lck(mtx);
+        end = true;
+    }
+    cv.notify_one();
+    th.join();
+}
+
+void Ckp::put(vector<char> &img)
+/* Hands an image to the thread (img is swapped out, so the caller's buffer is reused). */
+{
+    {
+        lock_guard<mutex> lck(mtx);
+        buf.swap(img);
+        pnd = true;
+    }
+    cv.notify_one();
+}
+
+void Ckp::wrk()
+/* Writes images as they arrive. */
+{
+    vector<char> img;
+    FILE *fp;
+    string tfn;
+    bool ok;
+    tfn = fn + ".tmp";
+    while (true)
+    {
+        {
+            unique_lock<mutex> lck(mtx);
+            cv.wait(lck, [this]{return pnd || end;});
+            if (!pnd)
+                return;
+            img.swap(buf);
+            pnd = false;
+        }
+        fp = fopen(tfn.c_str(), "wb");
+        ok = fp != NULL;
+        if (ok)
+        {
+            ok = fwrite(img.data(), 1, img.size(), fp) == img.size();
+            ok = fclose(fp) == 0 && ok;
+        }
+        ok = ok && rename(tfn.c_str(), fn.c_str()) == 0;
+        if (!ok)
+        {
+            lock_guard<mutex> lck(mtx);
+            err = "Error writing checkpoint " + fn + ".";
+        }
+    }
+}
+
+bool rdCkp(string fn, vector<char> &img)
+/* Reads a checkpoint file, returns false if there is none. */
+{
+    ifstream fs;
+    fs.open(fn, ios::binary);
+    if (!fs)
+        return false;
+    img.assign(istreambuf_iterator<char>(fs), istreambuf_iterator<char>());
+    return true;
+}
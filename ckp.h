@@ -0,0 +1,58 @@
+#ifndef CKP_H
+#define CKP_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "mdkp.h"
+
+#define CKP_MAG 0x4b43514d
+#define CKP_VER 1
+
+class Ckp
+/* Checkpoint writer, images of the swarm state are written to a file by a background thread so the solver does
+ * not wait for the disk, only the latest image is kept if the thread falls behind:
+ * fn = checkpoint file, written to fn.tmp then renamed so that a crash never leaves a partial file,
+ * buf = image waiting to be written,
+ * pnd = true if buf is waiting,
+ * end = true when the thread is to write what is pending and stop,
+ * err = error message of the last failed write.
+*/
+{
+public:
+    string fn, err;
+    Ckp(string fn0);
+    ~Ckp();
+    void put(vector<char> &img);
+    void cls();
+private:
+    thread th;
+    mutex mtx;
+    condition_variable cv;
+    vector<char> buf;
+    bool pnd, end;
+    void wrk();
+};
+
+template<typename T>
+void ckW(vector<char> &img, const T *p, int n)
+/* Appends n values to a checkpoint image. */
+{
+    const char *c = (const char *)p;
+    img.insert(img.end(), c, c + n*sizeof(T));
+}
+
+template<typename T>
+bool ckR(const vector<char> &img, size_t &at, T *p, int n)
+/* Reads n values from a checkpoint image at position at, returns false if the image is too short. */
+{
+    if (at + n*sizeof(T) > img.size())
+        return false;
+    copy(img.begin() + at, img.begin() + at + n*sizeof(T), (char *)p);
+    at += n*sizeof(T);
+    return true;
+}
+
+bool rdCkp(string fn, vector<char> &img);
+
+#endif
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include "elt.h"
+
+Elt::Elt(int n0, int itms0, int dh0, RlCb rl0)
+{
+    rl = rl0;
+    n = n0;
+    itms = itms0;
+    dh = dh0;
+    nrl = 0;
+    nim = 0;
+    ex.resize(n*itms);
+    ev.resize(n);
+    eid.resize(n);
+    bx.resize(itms);
+    nid = 0;
+    ne = 0;
+    bv = -1;
+    end = false;
+}
+
+Elt::~Elt()
+{
+    cls();
+}
+
+void Elt::put(const int x[], int v)
+/* Offers a solution to the archive: it replaces the nearest member if closer than dh to it (and better), otherwise
+ * it is added or replaces the worst member (if better).
+*/
+{
+    int i, j, c, d, dm, w;
+    {
+        lock_guard<mutex> lck(mtx);
+        c = -1;
+        dm = itms + 1;
+        w = 0;
+        for (i = 0; i < ne; i++)
+        {
+            d = 0;
+            for (j = 0; j < itms && d < dm; j++)
+                d += x[j] != ex[i*itms + j];
+            if (d < dm)
+            {
+                dm = d;
+                c = i;
+            }
+            if (ev[i] < ev[w])
+                w = i;
+        }
+        if (c >= 0 && dm < dh)
+        {
+            if (v <= ev[c])
+                return;
+            w = c;
+        }
+        else if (ne < n)
+            w = ne++;
+        else if (v <= ev[w])
+            return;
+        copy(x, x + itms, &ex[w*itms]);
+        ev[w] = v;
+        eid[w] = nid++;
+    }
+    cv.notify_all();
+}
+
+bool Elt::pr(int &p, int &q)
+/* Chooses the pair of members not yet relinked with the greatest total value (called with mtx held). */
+{
+    int i, j;
+    p = -1;
+    q = -1;
+    for (i = 0; i < ne; i++)
+        for (j = i + 1; j < ne; j++)
+            if ((p < 0 || ev[i] + ev[j] > ev[p] + ev[q]) && dn.count(make_pair(min(eid[i], eid[j]),
+                max(eid[i], eid[j]))) == 0)
+            {
+                p = i;
+                q = j;
+            }
+    if (p < 0)
+        return false;
+    dn.insert(make_pair(min(eid[p], eid[q]), max(eid[p], eid[q])));
+    // the better member starts the path so that it explores around the best solutions
+    if (ev[q] > ev[p])
+        swap(p, q);
+    return true;
+}
+
+void Elt::rlk(unique_lock<mutex> &lck, int p, int q)
+/* Relinks members p and q, called with lck held, returns with it released. */
+{
+    vector<int> a(itms), b(itms), x(itms);
+    int v, va, vb;
+    copy(&ex[p*itms], &ex[p*itms] + itms, a.begin());
+    copy(&ex[q*itms], &ex[q*itms] + itms, b.begin());
+    va = ev[p];
+    vb = ev[q];
+    lck.unlock();
+    v = rl(a.data(), b.data(), x.data());
+    lck.lock();
+    nrl++;
+    if (v > max(va, vb))
+        nim++;
+    if (v > bv)
+    {
+        bx = x;
+        bv = v;
+    }
+    lck.unlock();
+    if (v >= 0)
+        put(x.data(), v);
+}
+
+bool Elt::one()
+/* Relinks one pair, returns false if every pair has been relinked. */
+{
+    int p, q;
+    unique_lock<mutex> lck(mtx);
+    if (!pr(p, q))
+        return false;
+    rlk(lck, p, q);
+    return true;
+}
+
+bool Elt::get(int x[], int &v)
+/* Copies the best solution found by relinking to x if it is better than v. */
+{
+    lock_guard<mutex> lck(mtx);
+    if (bv <= v)
+        return false;
+    copy(bx.begin(), bx.end(), x);
+    v = bv;
+    return true;
+}
+
+void Elt::wrk()
+/* Worker: relinks pairs as they become available until the end. */
+{
+    int p, q;
+    while (true)
+    {
+        unique_lock<mutex> lck(mtx);
+        cv.wait(lck, [this, &p, &q]{return end || pr(p, q);});
+        if (end)
+            return;
+        rlk(lck, p, q);
+    }
+}
+
+void Elt::bgn(int k)
+/* Starts k workers. */
+{
+    int i;
+    end = false;
+    for (i = 0; i < k; i++)
+        wks.push_back(thread(&Elt::wrk, this));
+}
+
+void Elt::cls()
+/* Stops the workers, a relinking under way is finished first. */
+{
+    int i;
+    {
+        lock_guard<mutex> lck(mtx);
+        end = true;
+    }
+    cv.notify_all();
+    for (i = 0; i < (int)wks.size(); i++)
+        wks[i].join();
+    wks.clear();
+}
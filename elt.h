@@ -0,0 +1,55 @@
+#ifndef ELT_H
+#define ELT_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include "mdkp.h"
+
+class Elt
+/* Elite archive of diverse good solutions of a solve, with path relinking between pairs of them done inline or by
+ * background worker threads:
+ * n = capacity,
+ * itms = number of items,
+ * dh = minimum Hamming distance between members, a solution closer than dh to a member only replaces it if better,
+ * nrl = relinkings done,
+ * nim = relinkings that found a solution better than both ends,
+ * rl = path relinking of the solver, from a towards b into x, returns the value of x (-1 if none), fixed when
+ * the archive is made because the workers call it,
+ * ex, ev, eid = solutions, values and identifiers of the members (ne of them),
+ * nid = next identifier,
+ * dn = pairs of identifiers already relinked,
+ * bx, bv = best solution found by relinking,
+ * wks = worker threads,
+ * mtx, cv = archive lock and signal (a new member or the end),
+ * end = true when the workers are to stop.
+*/
+{
+public:
+    int n, itms, dh;
+    long long nrl, nim;
+    Elt(int n0, int itms0, int dh0, RlCb rl0);
+    ~Elt();
+    void put(const int x[], int v);
+    bool one();
+    bool get(int x[], int &v);
+    void bgn(int k);
+    void cls();
+private:
+    RlCb rl;
+    vector<int> ex, ev, bx;
+    vector<long long> eid;
+    set<pair<long long, long long> > dn;
+    long long nid;
+    int ne, bv;
+    vector<thread> wks;
+    mutex mtx;
+    condition_variable cv;
+    bool end;
+    bool pr(int &p, int &q);
+    void rlk(unique_lock<mutex> &lck, int p, int q);
+    void wrk();
+};
+
+#endif
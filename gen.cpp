@@ -0,0 +1,223 @@
+/* Streaming instance generator: instances are written to disk row by row without holding the weight matrix, the
+ * memory used is O(n + m). Every row of weights is drawn from its own seeded stream, so a row can be drawn again
+ * (the correlated type needs the column sums of the weights before the first row is written) and the files are
+ * the same whatever the number of threads.
+ *
+ * Uncorrelated (GEN_UNC): w[i][j] = U(0, GEN_WMX), p[j] = U(1, GEN_PMX).
+ * Correlated (GEN_CB): w[i][j] = U(0, GEN_WMX), p[j] = sum(w[i][j], i)/m + U(0, GEN_PNS).
+ * Both: c[i] = tt*sum(w[i][j], j).
+*/
+
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "gen.h"
+
+class GWr
+/* Buffered writer of integers:
+ * fp = file,
+ * buf = buffer,
+ * n = number of characters in the buffer.
+*/
+{
+public:
+    FILE *fp;
+    vector<char> buf;
+    int n;
+    GWr(FILE *fp0);
+    ~GWr();
+    void num(int64_t v, char sep);
+    void fls();
+};
+
+GWr::GWr(FILE *fp0)
+{
+    fp = fp0;
+    buf.resize(GEN_BUF);
+    n = 0;
+}
+
+GWr::~GWr()
+{
+    fls();
+}
+
+void GWr::num(int64_t v, char sep)
+/* Writes an integer followed by a separator. */
+{
+    char d[24];
+    int k;
+    uint64_t u;
+    if (n > GEN_BUF - 32)
+        fls();
+    if (v < 0)
+        buf[n++] = '-';
+    u = v < 0 ? -(uint64_t)v : v;
+    k = 0;
+    do
+    {
+        d[k++] = '0' + u % 10;
+        u /= 10;
+    } while (u > 0);
+    while (k > 0)
+        buf[n++] = d[--k];
+    buf[n++] = sep;
+}
+
+void GWr::fls()
+/* Writes the buffer to the file. */
+{
+    if (n > 0)
+        fwrite(buf.data(), 1, n, fp);
+    n = 0;
+}
+
+GPrm::GPrm()
+/* Default parameters. */
+{
+    se = DEFA_SE;
+    n = DEFA_GN;
+    m = DEFA_GM;
+    k = DEFA_GK;
+    typ = DEFA_GTY;
+    tt = DEFA_GT;
+    orl = 0;
+    thr = 1;
+}
+
+uint64_t genSe(uint64_t se, uint64_t k)
+/* Returns the seed of stream k derived from seed se. */
+{
+    Rng rnd(se ^ (k + 1)*0x9e3779b97f4a7c15ull);
+    return rnd.nxt();
+}
+
+void genRow(Rng &rnd, uint64_t se, int i, int n, vector<int> &w)
+/* Draws row i of the weights of an instance:
+ * se = seed of the instance,
+ * w = weights (output).
+*/
+{
+    int j;
+    rnd.srnd(genSe(se, i));
+    for (j = 0; j < n; j++)
+        w[j] = rnd.rndU(0, GEN_WMX);
+}
+
+void genPrb(GWr &wr, const GPrm &gp, uint64_t se)
+/* Writes an instance in the data file format:
+ * se = seed of the instance, rows 0 to m - 1 are the weights and row m the values.
+*/
+{
+    Rng rnd;
+    vector<int> w(gp.n);
+    vector<int64_t> cs, rs(gp.m, 0);
+    int i, j;
+    wr.num(gp.n, ' ');
+    wr.num(gp.m, ' ');
+    wr.num(0, '\n');
+    if (gp.typ == GEN_CB)
+    {
+        cs.assign(gp.n, 0);
+        for (i = 0; i < gp.m; i++)
+        {
+            genRow(rnd, se, i, gp.n, w);
+            for (j = 0; j < gp.n; j++)
+                cs[j] += w[j];
+        }
+    }
+    rnd.srnd(genSe(se, gp.m));
+    for (j = 0; j < gp.n; j++)
+        if (gp.typ == GEN_CB)
+            wr.num(cs[j]/gp.m + rnd.rndU(0, GEN_PNS), j < gp.n - 1 ? ' ' : '\n');
+        else
+            wr.num(rnd.rndU(1, GEN_PMX), j < gp.n - 1 ? ' ' : '\n');
+    for (i = 0; i < gp.m; i++)
+    {
+        genRow(rnd, se, i, gp.n, w);
+        for (j = 0; j < gp.n; j++)
+        {
+            rs[i] += w[j];
+            wr.num(w[j], j < gp.n - 1 ? ' ' : '\n');
+        }
+    }
+    for (i = 0; i < gp.m; i++)
+        wr.num((int64_t)floor(gp.tt*rs[i]), i < gp.m - 1 ? ' ' : '\n');
+}
+
+bool genFl(const GPrm &gp, int f, string &err)
+/* Writes file f, instances f*orl to f*orl + orl - 1 (or instance f if orl is zero). */
+{
+    FILE *fp;
+    string fn;
+    int k, k0, k1;
+    fn = gp.dn + "/g" + to_string(f + 1) + ".txt";
+    fp = fopen(fn.c_str(), "w");
+    if (fp == NULL)
+    {
+        err = "Error opening file " + fn + ".";
+        return false;
+    }
+    {
+        GWr wr(fp);
+        if (gp.orl > 0)
+        {
+            k0 = f*gp.orl;
+            k1 = min(k0 + gp.orl, gp.k);
+            wr.num(k1 - k0, '\n');
+        }
+        else
+        {
+            k0 = f;
+            k1 = f + 1;
+        }
+        for (k = k0; k < k1; k++)
+            genPrb(wr, gp, genSe(gp.se, k));
+    }
+    if (fclose(fp) != 0)
+    {
+        err = "Error writing file " + fn + ".";
+        return false;
+    }
+    return true;
+}
+
+bool gen(const GPrm &gp, string &err)
+/* Generates the instances, the files are shared out between the threads. */
+{
+    vector<thread> wks;
+    atomic<int> nxt;
+    mutex mtx;
+    int i, fls, thr;
+    if (gp.n < 1 || gp.n > GEN_NMX || gp.m < 1 || gp.m > GEN_MMX || gp.k < 1)
+    {
+        err = "generator size out of range";
+        return false;
+    }
+    if (gp.typ != GEN_UNC && gp.typ != GEN_CB)
+    {
+        err = "bad generator type";
+        return false;
+    }
+    fls = gp.orl > 0 ? (gp.k + gp.orl - 1)/gp.orl : gp.k;
+    thr = max(1, min(gp.thr, fls));
+    nxt = 0;
+    err = "";
+    for (i = 0; i < thr; i++)
+        wks.push_back(thread([&]()
+        {
+            string e;
+            int f;
+            while ((f = nxt++) < fls)
+                if (!genFl(gp, f, e))
+                {
+                    lock_guard<mutex> lck(mtx);
+                    err = e;
+                }
+        }));
+    for (i = 0; i < thr; i++)
+        wks[i].join();
+    return err == "";
+}
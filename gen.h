@@ -0,0 +1,40 @@
+#include "mdkp.h"
+
+#define GEN_UNC 0
+#define GEN_CB 1
+#define GEN_WMX 1000
+#define GEN_PMX 1000
+#define GEN_PNS 500
+#define GEN_BUF 1048576
+#define GEN_NMX 1000000
+#define GEN_MMX 10000
+
+#define DEFA_GN 500
+#define DEFA_GM 30
+#define DEFA_GK 10
+#define DEFA_GTY GEN_CB
+#define DEFA_GT 0.5
+
+struct GPrm
+/* Instance generator parameters:
+ * dn = output directory,
+ * se = seed, instance k and row i of it are generated from independent streams derived from se, k and i,
+ * n = number of items,
+ * m = number of dimensions (constraints),
+ * k = number of instances,
+ * typ = type (GEN_UNC uncorrelated, GEN_CB correlated as in Chu and Beasley 1998),
+ * tt = tightness ratio (capacity over the sum of the weights of a constraint),
+ * orl = instances per file in the OR-Library multi-instance format (zero for one instance per file in the data
+ * file format),
+ * thr = number of threads (files are generated in parallel).
+*/
+{
+    string dn;
+    uint64_t se;
+    int n, m, k, typ, orl, thr;
+    double tt;
+    GPrm();
+};
+
+uint64_t genSe(uint64_t se, uint64_t k);
+bool gen(const GPrm &gp, string &err);
@@ -23,11 +23,18 @@
 #include <vector>
 #include <algorithm>
 #include <dirent.h>
+#include <thread>
 #include "sys_stk.h"
 #include "mdkp.h"
+#include "srv.h"
+#include "out.h"
+#include "gen.h"
+#include "tune.h"
+#include "cch.h"
+#include "sch.h"
+#include "aff.h"
 
 #define STK_SZ 1024*1024
-#define MX_RNS 30
 #define MN_PREC 2
 #define MX_PRBS 1000
 #define STA_NON 0
@@ -42,80 +49,237 @@
 #define STA_EP2 9
 #define STA_STY 10
 #define STA_NWL 11
+#define STA_LP 12
+#define STA_WSOL 13
+#define STA_WBAS 14
+#define STA_WMX 15
+#define STA_SSOL 16
+#define STA_SBAS 17
+#define STA_SRV 18
+#define STA_THR 19
+#define STA_FMT 20
+#define STA_SFM 21
+#define STA_GEN 22
+#define STA_GN 23
+#define STA_GM 24
+#define STA_GK 25
+#define STA_GTY 26
+#define STA_GT 27
+#define STA_GOR 28
+#define STA_TUN 29
+#define STA_TNC 30
+#define STA_TTL 31
+#define STA_TMS 32
+#define STA_CKP 33
+#define STA_CKI 34
+#define STA_PRF 35
+#define STA_CCH 36
+#define STA_SCH 37
+#define STA_SBUD 38
+#define STA_SK 39
+#define STA_AFF 40
+#define STA_RPL 41
+#define STA_SCL 42
+#define STA_ELT 43
+#define STA_EDH 44
+#define STA_PRW 45
 
 #define INC_STR "incorrect argument(s)"
 #define ARGS_STR "arguments error: "
 
-#define DEFA_SE 198671
 #define DEFA_RNS 30
-#define DEFA_SZ 20
-#define DEFA_MX 500
-#define DEFA_ALP 0.1
-#define DEFA_EP1 0.4
-#define DEFA_EP2 0.2
 #define DEFA_STY 0
 #define DEFA_NWL false
+#define DEFA_FMT FMT_TXT
+#define DEFA_SFM SFM_IDX
 
 using namespace std;
 
-MdKP mdkp;
-MdKPQ mdkpq;
-double alp, ep1, ep2;
-int se, rns, sz, mx, sty, nwl;
+struct Cli
+/* Command line settings:
+ * prm = solver parameters (prm.se is the seed of the seeds of the runs),
+ * rns = number of runs,
+ * sty = output style,
+ * nwl = new lines between outputs,
+ * fmt = output format (FMT_TXT, FMT_JSL or FMT_CSV),
+ * sfm = solution format in machine readable output (SFM_IDX or SFM_BMP),
+ * dn = instance directory,
+ * fn = input filename,
+ * wsfn = warm start solution file,
+ * ssfn = file to save the best solution to (these and the basis files of prm are suffixed .p for problem p of a
+ * directory),
+ * ckfn = checkpoint file prefix, the file of run r of problem p is ckfn.p.r,
+ * cdn = cache directory of prepared instances (empty for none),
+ * sadr = solve server address (Unix domain socket path, or - for stdin),
+ * scfn = problem file of the thread scaling report,
+ * thr = number of worker threads,
+ * aff = placement policy of the worker threads (AFF_NON, AFF_CMP or AFF_SCT),
+ * rpl = true to give each node its own copy of the prepared instance,
+ * gp = instance generator parameters (gp.dn is the output directory, gp.se and gp.thr are taken from prm.se and
+ * thr),
+ * tp = parameter racing parameters (tp.dn is the training directory, tp.prm, tp.thr, tp.aff and tp.rpl are taken
+ * from prm, thr, aff and rpl),
+ * sp = scheduler parameters (sp.dn is the instance directory, sp.prm, sp.thr and sp.aff are taken from prm, thr
+ * and aff).
+*/
+{
+    Prm prm;
+    GPrm gp;
+    TPrm tp;
+    SPrm sp;
+    int rns, sty, thr, fmt, sfm, aff;
+    bool nwl, rpl;
+    string dn, fn, wsfn, ssfn, ckfn, cdn, sadr, scfn;
+};
 
-void slv()
+string prbFn(const Cli &cli, string fn, string prb)
+/* Returns the name of the solution or basis file fn for a problem: fn itself for an input file, fn.p for problem p
+ * of a directory (so the problems do not share one file).
+*/
 {
-    int ses[MX_RNS], i, sum, bst, tm;
+    if (fn == "" || cli.dn == "")
+        return fn;
+    return fn + "." + prb.substr(prb.find_last_of('/') + 1);
+}
+
+void slv(MdKPQ &mdkpq, MdKPS mdkp, string prb, Cli &cli, Snk &snk)
+/* Runs the algorithm rns times with seeds drawn from prm.se and outputs a record per run and for the problem. */
+{
+    vector<uint64_t> ses;
+    vector<int> bsol;
+    Prm prm;
+    Res res;
+    PrfSt agg;
+    Rng rng;
+    string err, wsfn, ssfn;
+    int i, sum, bst, tm;
     sum = 0;
     bst = 0;
     tm = 0;
-    srand(se);
-	cout << fixed << setprecision(MN_PREC);
-    for (i = 0; i < rns; i++)
-        ses[i] = rand();
-    for (i = 0; i < rns; i++)
+    prm = cli.prm;
+    prm.wbas = prbFn(cli, cli.prm.wbas, prb);
+    prm.sbas = prbFn(cli, cli.prm.sbas, prb);
+    wsfn = prbFn(cli, cli.wsfn, prb);
+    ssfn = prbFn(cli, cli.ssfn, prb);
+    rng.srnd(prm.se);
+    for (i = 0; i < cli.rns; i++)
+        ses.push_back(rng.nxt());
+    if (wsfn != "")
+    {
+        if (!rdSol(wsfn, mdkp->itms, prm.wsol, err))
+        {
+            snk.err(prb, err);
+            return;
+        }
+        snk.msg("warm start, wmx = " + to_string(prm.wmx) + (prm.wbas != "" ? ", basis " + prm.wbas : ""));
+    }
+    for (i = 0; i < cli.rns; i++)
+    {
+        prm.se = ses[i];
+        if (cli.ckfn != "")
+            prm.ckp = cli.ckfn + "." + prb.substr(prb.find_last_of('/') + 1) + "." + to_string(i + 1);
+        mdkpq.ini(prm);
+        res = mdkpq.slv(mdkp);
+        if (res.stp == STP_ERR)
+        {
+            snk.err(prb, res.err);
+            return;
+        }
+        snk.run(prb, i + 1, prm.se, mdkp->opt, res);
+        if (res.prf.on)
+        {
+            snk.prf(prb, i + 1, res.prf);
+            agg.add(res.prf);
+        }
+        sum += res.v;
+        tm += res.tm;
+        if (res.v > bst)
+        {
+            bst = res.v;
+            bsol = res.x;
+        }
+    }
+    if (ssfn != "" && bsol.size() > 0 && !wrSol(ssfn, bsol, err))
+        snk.err(prb, err);
+    if (agg.on)
+        snk.prf(prb, 0, agg);
+    snk.inst(prb, cli.rns, bst, (double)sum/cli.rns, tm, mdkp->opt);
+    snk.flsh();
+}
+
+void ini(MdKPQ &mdkpq, Cli &cli, Snk &snk)
+{
+    ostringstream os;
+    os << fixed << setprecision(MN_PREC) << "sz = " << cli.prm.sz << ", mx = " << cli.prm.mx << ", alp = "
+        << cli.prm.alp << ", ep1 = " << cli.prm.ep1 << ", ep2 = " << cli.prm.ep2 << ", lp = " << lpName(cli.prm.lpm);
+    snk.msg(mdkpq.name());
+    snk.msg(os.str());
+}
+
+MdKPS ldFl(MdKPQ &mdkpq, string fn, Cli &cli, Snk &snk, CchK &ck, string &err)
+/* Loads a problem from file, from the cache if it holds a valid entry (the prepared view is then given to the
+ * solver so the solves skip the LP and the sort), the cache is not used with an LP basis file:
+ * ck = key of the cache entry to write after the solves (ck.fn is empty if none).
+*/
+{
+    MdKPVS pv;
+    ck.fn = "";
+    if (cli.cdn == "" || cli.prm.wbas != "" || cli.prm.sbas != "")
+        return ldPrb(fn, err);
+    pv = ldCch(fn, cli.cdn, cli.prm.lpm, ck, err);
+    if (pv != nullptr)
     {
-        srand(ses[i]);
-        cout << "run " << i + 1 << endl;
-        mdkpq.slv(mdkp, true);
-        sum += mdkpq.v_sol;
-        tm += mdkpq.tm;
-        if (mdkpq.v_sol > bst)
-            bst = mdkpq.v_sol;
+        snk.msg("cached " + ck.fn);
+        mdkpq.prp = pv;
+        ck.fn = "";
+        return pv->src;
     }
-    cout << "bst = " << bst << ", avg = " << (double)sum/rns << ", tm = " << tm << ", atm = " << (double)tm/rns << " ms" << endl;
+    return ldPrb(fn, err);
 }
 
-void ini()
+void svFl(MdKPQ &mdkpq, MdKPS mdkp, Snk &snk, CchK &ck)
+/* Writes the cache entry of a problem once it has been prepared. */
 {
-    mdkpq.info();
-    mdkpq.ini(sz, mx, alp, ep1, ep2, true, sty, nwl);
+    string err;
+    if (ck.fn != "" && mdkpq.prp != nullptr && mdkpq.prp->src == mdkp && !wrCch(ck, mdkpq.prp, err))
+        snk.err(mdkp->pfn, err);
 }
 
-void slvFl(string fn)
+void slvFl(Cli &cli, Snk &snk)
 /* Reads a problem from file, runs an algorithm and outputs results. */
 {
-    cout << "solving " << fn << ":" << endl;
-    if (mdkp.rdPrb(fn))
+    MdKPQ mdkpq;
+    MdKPS mdkp;
+    CchK ck;
+    string err;
+    snk.msg("solving " + cli.fn + ":");
+    mdkp = ldFl(mdkpq, cli.fn, cli, snk, ck, err);
+    if (mdkp != nullptr)
     {
-        ini();
-        slv();
+        ini(mdkpq, cli, snk);
+        slv(mdkpq, mdkp, cli.fn, cli, snk);
+        svFl(mdkpq, mdkp, snk, ck);
     }
+    else
+        snk.err(cli.fn, err);
 }
 
-void slvDir(string dn)
+void slvDir(Cli &cli, Snk &snk)
 /* Solves all instances in a directory. */
 {
+    MdKPQ mdkpq;
+    MdKPS mdkp;
     DIR* dir;
     dirent* pdir;
+    CchK ck;
     vector<string> fls;
     vector<string>::size_type v, np;
-    string str, dstr;
-    cout << "solving instances in " << dn << ":" << endl;
-    dstr = dn.c_str();
-    dir = opendir(dn.c_str());
+    string str, dstr, err;
+    snk.msg("solving instances in " + cli.dn + ":");
+    dstr = cli.dn;
+    dir = opendir(cli.dn.c_str());
     if (dir == NULL)
-        cout << "bad directory" << endl;
+        snk.err(cli.dn, "bad directory");
     else
     {
         while ((pdir = readdir(dir)) != NULL)
@@ -124,24 +288,29 @@ void slvDir(string dn)
             if (str != "." && str != ".." && str != "README.txt")
                 fls.push_back(str);
         }
+        closedir(dir);
         sort(fls.begin(), fls.end());
         np = fls.size();
         if (np > MX_PRBS)
         {
-            cout << "too many problem files, limit is " << MX_PRBS << endl;
+            snk.err(cli.dn, "too many problem files, limit is " + to_string(MX_PRBS));
             return;
         }
-        ini();
+        ini(mdkpq, cli, snk);
         for(v = 0; v < np; v++)
         {
-            cout << endl;
-            cout << "solving file " << fls[v] << endl;
-            if (mdkp.rdPrb(dstr + "/" + fls[v]))
+            snk.msg("");
+            snk.msg("solving file " + fls[v]);
+            mdkp = ldFl(mdkpq, dstr + "/" + fls[v], cli, snk, ck, err);
+            if (mdkp != nullptr)
             {
-                if (mdkp.opt > 0)
-                    cout << "opt = " << mdkp.opt << ", se = " << se << endl;
-                slv();
+                if (mdkp->opt > 0)
+                    snk.msg("opt = " + to_string(mdkp->opt) + ", se = " + to_string(cli.prm.se));
+                slv(mdkpq, mdkp, fls[v], cli, snk);
+                svFl(mdkpq, mdkp, snk, ck);
             }
+            else
+                snk.err(fls[v], err);
         }
     }
 }
@@ -149,23 +318,23 @@ void slvDir(string dn)
 int main(int argc, char **argv)
 {
     vector<std::string> arg;
-    string err, dn, fn;
+    string err;
     int i, sta;
-    cout << "MdKPQ program" << endl;
+    bool ok;
+    Cli cli;
+    unique_ptr<Snk> snk;
     if (!setStkSz(STK_SZ))
         return 0;
     err = "";
-    dn = "";
-    fn = "";
-    se = DEFA_SE;
-    rns = DEFA_RNS;
-    sz = DEFA_SZ;
-    mx = DEFA_MX;
-    alp = DEFA_ALP;
-    ep1 = DEFA_EP1;
-    ep2 = DEFA_EP2;
-    sty = DEFA_STY;
-    nwl = DEFA_NWL;
+    ok = true;
+    cli.rns = DEFA_RNS;
+    cli.sty = DEFA_STY;
+    cli.nwl = DEFA_NWL;
+    cli.fmt = DEFA_FMT;
+    cli.sfm = DEFA_SFM;
+    cli.thr = thread::hardware_concurrency();
+    cli.aff = AFF_NON;
+    cli.rpl = false;
     if (argc > 1)
     {
         arg.assign(argv + 1, argv + argc);
@@ -176,57 +345,233 @@ int main(int argc, char **argv)
             {
                 if (sta == STA_DIR)
                 {
-                    dn = arg[i];
+                    cli.dn = arg[i];
                     sta = STA_NON;
                 }
                 else if (sta == STA_INP)
                 {
-                    fn = arg[i];
+                    cli.fn = arg[i];
                     sta = STA_NON;
                 }
                 else if (sta == STA_SE)
                 {
-                    se = atoi(arg[i].c_str());
+                    cli.prm.se = strtoull(arg[i].c_str(), NULL, 10);
                     sta = STA_NON;
                 }
                 else if (sta == STA_RNS)
                 {
-                    rns = atoi(arg[i].c_str());
+                    cli.rns = atoi(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_SZ)
                 {
-                    sz = atoi(arg[i].c_str());
+                    cli.prm.sz = atoi(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_MX)
                 {
-                    mx = atoi(arg[i].c_str());
+                    cli.prm.mx = atoi(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_ALP)
                 {
-                    alp = atof(arg[i].c_str());
+                    cli.prm.alp = atof(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_EP1)
                 {
-                    ep1 = atof(arg[i].c_str());
+                    cli.prm.ep1 = atof(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_EP2)
                 {
-                    ep2 = atof(arg[i].c_str());
+                    cli.prm.ep2 = atof(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_STY)
                 {
-                    sty = atoi(arg[i].c_str());
+                    cli.sty = atoi(arg[i].c_str());
                     sta = STA_NON;
                 }
                 else if (sta == STA_NWL)
                 {
-                    nwl = arg[i] == "1";
+                    cli.nwl = arg[i] == "1";
+                    sta = STA_NON;
+                }
+                else if (sta == STA_LP)
+                {
+                    cli.prm.lpm = atoi(arg[i].c_str());
+                    if (cli.prm.lpm < LP_PRM || cli.prm.lpm > LP_PRE)
+                        err = string(INC_STR) + string(": -lp ") + string(arg[i]);
+                    sta = STA_NON;
+                }
+                else if (sta == STA_WSOL)
+                {
+                    cli.wsfn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_WBAS)
+                {
+                    cli.prm.wbas = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_WMX)
+                {
+                    cli.prm.wmx = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SSOL)
+                {
+                    cli.ssfn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SBAS)
+                {
+                    cli.prm.sbas = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SRV)
+                {
+                    cli.sadr = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_THR)
+                {
+                    cli.thr = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_FMT)
+                {
+                    cli.fmt = atoi(arg[i].c_str());
+                    if (cli.fmt < FMT_TXT || cli.fmt > FMT_CSV)
+                        err = string(INC_STR) + string(": -fmt ") + string(arg[i]);
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SFM)
+                {
+                    cli.sfm = atoi(arg[i].c_str());
+                    if (cli.sfm < SFM_IDX || cli.sfm > SFM_BMP)
+                        err = string(INC_STR) + string(": -sfm ") + string(arg[i]);
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GEN)
+                {
+                    cli.gp.dn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GN)
+                {
+                    cli.gp.n = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GM)
+                {
+                    cli.gp.m = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GK)
+                {
+                    cli.gp.k = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GTY)
+                {
+                    cli.gp.typ = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GT)
+                {
+                    cli.gp.tt = atof(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_GOR)
+                {
+                    cli.gp.orl = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_TUN)
+                {
+                    cli.tp.dn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_TNC)
+                {
+                    cli.tp.nc = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_TTL)
+                {
+                    cli.tp.tl = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_TMS)
+                {
+                    cli.tp.mxs = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_CKP)
+                {
+                    cli.ckfn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_CKI)
+                {
+                    cli.prm.cki = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SCH)
+                {
+                    cli.sp.dn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SBUD)
+                {
+                    cli.sp.bud = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SK)
+                {
+                    cli.sp.k = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_AFF)
+                {
+                    cli.aff = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_RPL)
+                {
+                    cli.rpl = arg[i] == "1";
+                    sta = STA_NON;
+                }
+                else if (sta == STA_SCL)
+                {
+                    cli.scfn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_ELT)
+                {
+                    cli.prm.elt = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_EDH)
+                {
+                    cli.prm.edh = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_PRW)
+                {
+                    cli.prm.prw = atoi(arg[i].c_str());
+                    sta = STA_NON;
+                }
+                else if (sta == STA_CCH)
+                {
+                    cli.cdn = arg[i];
+                    sta = STA_NON;
+                }
+                else if (sta == STA_PRF)
+                {
+                    cli.prm.prf = arg[i] == "1";
                     sta = STA_NON;
                 }
                 else if (arg[i] == "-dir")
@@ -251,6 +596,76 @@ int main(int argc, char **argv)
                     sta = STA_STY;
                 else if (arg[i] == "-n")
                     sta = STA_NWL;
+                else if (arg[i] == "-lp")
+                    sta = STA_LP;
+                else if (arg[i] == "-wsol")
+                    sta = STA_WSOL;
+                else if (arg[i] == "-wbas")
+                    sta = STA_WBAS;
+                else if (arg[i] == "-wmx")
+                    sta = STA_WMX;
+                else if (arg[i] == "-ssol")
+                    sta = STA_SSOL;
+                else if (arg[i] == "-sbas")
+                    sta = STA_SBAS;
+                else if (arg[i] == "-srv")
+                    sta = STA_SRV;
+                else if (arg[i] == "-thr")
+                    sta = STA_THR;
+                else if (arg[i] == "-fmt")
+                    sta = STA_FMT;
+                else if (arg[i] == "-sfm")
+                    sta = STA_SFM;
+                else if (arg[i] == "-gen")
+                    sta = STA_GEN;
+                else if (arg[i] == "-gn")
+                    sta = STA_GN;
+                else if (arg[i] == "-gm")
+                    sta = STA_GM;
+                else if (arg[i] == "-gk")
+                    sta = STA_GK;
+                else if (arg[i] == "-gty")
+                    sta = STA_GTY;
+                else if (arg[i] == "-gt")
+                    sta = STA_GT;
+                else if (arg[i] == "-gor")
+                    sta = STA_GOR;
+                else if (arg[i] == "-tune")
+                    sta = STA_TUN;
+                else if (arg[i] == "-tnc")
+                    sta = STA_TNC;
+                else if (arg[i] == "-ttl")
+                    sta = STA_TTL;
+                else if (arg[i] == "-tms")
+                    sta = STA_TMS;
+                else if (arg[i] == "-ckp")
+                    sta = STA_CKP;
+                else if (arg[i] == "-cki")
+                    sta = STA_CKI;
+                else if (arg[i] == "-resume")
+                    cli.prm.rsm = true;
+                else if (arg[i] == "-prf")
+                    sta = STA_PRF;
+                else if (arg[i] == "-cch")
+                    sta = STA_CCH;
+                else if (arg[i] == "-sch")
+                    sta = STA_SCH;
+                else if (arg[i] == "-sbud")
+                    sta = STA_SBUD;
+                else if (arg[i] == "-sk")
+                    sta = STA_SK;
+                else if (arg[i] == "-aff")
+                    sta = STA_AFF;
+                else if (arg[i] == "-rpl")
+                    sta = STA_RPL;
+                else if (arg[i] == "-scl")
+                    sta = STA_SCL;
+                else if (arg[i] == "-elt")
+                    sta = STA_ELT;
+                else if (arg[i] == "-edh")
+                    sta = STA_EDH;
+                else if (arg[i] == "-prw")
+                    sta = STA_PRW;
                 else
                     err = string(INC_STR) + string(": ") + string(arg[i]);
             }
@@ -264,14 +679,45 @@ int main(int argc, char **argv)
     }
     else
         err = "no arguments given";
+    // in stdin server mode stdout is the result stream
+    if (err != "" || (cli.fmt == FMT_TXT && cli.sadr != SRV_STDIN))
+        cout << "MdKPQ program" << endl;
     if (err == "")
     {
-        if (dn != "")
-            slvDir(dn);
-        else if (fn != "")
-            slvFl(fn);
+        snk = mkSnk(cli.fmt, cli.sty, cli.nwl, cli.sfm);
+        if (cli.gp.dn != "")
+        {
+            cli.gp.se = cli.prm.se;
+            cli.gp.thr = cli.thr;
+            if (gen(cli.gp, err))
+                cout << "generated " << cli.gp.k << " instances in " << cli.gp.dn << endl;
+        }
+        else if (cli.tp.dn != "")
+        {
+            cli.tp.prm = cli.prm;
+            cli.tp.thr = cli.thr;
+            cli.tp.aff = cli.aff;
+            cli.tp.rpl = cli.rpl;
+            tune(cli.tp, err);
+        }
+        else if (cli.sp.dn != "")
+        {
+            cli.sp.prm = cli.prm;
+            cli.sp.thr = cli.thr;
+            cli.sp.aff = cli.aff;
+            sch(cli.sp, err);
+        }
+        else if (cli.scfn != "")
+            scl(cli.scfn, cli.prm, cli.rns, cli.thr, cli.aff, cli.rpl, err);
+        else if (cli.sadr != "")
+            ok = srv(cli.sadr, cli.prm, cli.thr, cli.aff);
+        else if (cli.dn != "")
+            slvDir(cli, *snk);
+        else if (cli.fn != "")
+            slvFl(cli, *snk);
         else
-            err = "directory or file name not specified";
+            err = "directory, file name, server address, generator, training, scheduler directory or scaling file not"
+                " specified";
     }
     if (err != "")
     {
@@ -280,6 +726,16 @@ int main(int argc, char **argv)
         cout << "dir - instance directory" << endl;
         cout << "(or...)" << endl;
         cout << "inp - input filename" << endl;
+        cout << "(or...)" << endl;
+        cout << "srv - run as a solve server on a Unix domain socket path, or - for stdin" << endl;
+        cout << "(or...)" << endl;
+        cout << "gen - generate instances into a directory (files g1.txt, g2.txt, ...)" << endl;
+        cout << "(or...)" << endl;
+        cout << "tune - race parameter configurations on a training directory (a family per subdirectory)" << endl;
+        cout << "(or...)" << endl;
+        cout << "sch - solve a directory within a total time budget shared out by progress" << endl;
+        cout << "(or...)" << endl;
+        cout << "scl - report the throughput of runs of a problem file on 1, 2, 4, ... and thr threads" << endl;
         cout << "optional arguments:" << endl;
         cout << "se - random number seed" << endl;
         cout << "rns - number of runs" << endl;
@@ -291,6 +747,40 @@ int main(int argc, char **argv)
         cout << "ep2 - (epsilon 2) parameter" << endl;
         cout << "sty - output style (0 - 4)" << endl;
         cout << "nwl - switch that turns on new lines between outputs (0 or 1)" << endl;
+        cout << "fmt - output format (0 - text, 1 - JSON Lines, 2 - CSV)" << endl;
+        cout << "sfm - solution format for JSON Lines and CSV (0 - item numbers, 1 - bitmap)" << endl;
+        cout << "lp - linear relaxation method (0 - primal, 1 - dual, 2 - presolve and dual)" << endl;
+        cout << "ssol - file to save the best solution to" << endl;
+        cout << "sbas - file to save the LP basis to" << endl;
+        cout << "wsol - previous solution file, warm starts a re-solve of a perturbed problem" << endl;
+        cout << "wbas - previous LP basis file, warm starts the LP" << endl;
+        cout << "(with dir, ssol, sbas, wsol and wbas name a file per problem, followed by . and the problem file name)"
+            << endl;
+        cout << "wmx - maximum iterations when warm started" << endl;
+        cout << "thr - number of worker threads" << endl;
+        cout << "aff - placement of worker threads (0 - none, 1 - compact, pinned to cpus in order, 2 - scatter,"
+            << " pinned across NUMA nodes in turn)" << endl;
+        cout << "rpl - switch that turns on a copy of the prepared instance per NUMA node (0 or 1)" << endl;
+        cout << "gn - number of items of generated instances" << endl;
+        cout << "gm - number of dimensions of generated instances" << endl;
+        cout << "gk - number of generated instances" << endl;
+        cout << "gty - generator type (0 - uncorrelated, 1 - correlated as Chu and Beasley)" << endl;
+        cout << "gt - tightness ratio of generated instances" << endl;
+        cout << "gor - instances per file in the OR-Library format (0 - one instance per file)" << endl;
+        cout << "tnc - number of configurations raced" << endl;
+        cout << "ttl - time budget of each racing run (ms)" << endl;
+        cout << "tms - maximum number of racing stages" << endl;
+        cout << "ckp - checkpoint file prefix (a file per problem and run)" << endl;
+        cout << "cki - iterations between checkpoints" << endl;
+        cout << "resume - resume the runs from their checkpoints (no value)" << endl;
+        cout << "sbud - total time budget of the scheduler (ms)" << endl;
+        cout << "sk - iterations per scheduler work unit" << endl;
+        cout << "cch - cache directory of prepared instances (skips parsing, LP and sort when valid)" << endl;
+        cout << "prf - switch that turns on performance counts of prep, update, repair and local search (0 or 1)"
+            << endl;
+        cout << "elt - size of the elite archive path relinked during a solve (0 - none)" << endl;
+        cout << "edh - minimum Hamming distance between elite solutions" << endl;
+        cout << "prw - path relinking worker threads per solve (0 - one relinking per iteration, repeatable)" << endl;
     }
-    return 0;
+    return ok && err == "" ? 0 : 1;
 }
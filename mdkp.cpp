@@ -1,45 +1,170 @@
 #include <cmath>
 #include <climits>
 #include <stdlib.h>
+#include <algorithm>
 #include "mdkp.h"
 #include "srt.h"
 
-int calcMs(millisecs dur)
+int calcMs(chrono::nanoseconds dur)
+/* Returns a duration in whole milliseconds. */
 {
-    return dur.count();
+    return chrono::duration_cast<millisecs>(dur).count();
 }
 
-int rndU(int lo, int up)
+double calcMsD(chrono::nanoseconds dur)
+/* Returns a duration in milliseconds with a fractional part. */
+{
+    return chrono::duration_cast<millisecsD>(dur).count();
+}
+
+Rng::Rng(uint64_t se)
+{
+    srnd(se);
+}
+
+void Rng::srnd(uint64_t se)
+/* Seeds the generator. */
+{
+    s = se;
+}
+
+uint64_t Rng::nxt()
+/* Returns the next 64 random bits. */
+{
+    uint64_t z;
+    s += 0x9e3779b97f4a7c15ull;
+    z = s;
+    z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27))*0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+int Rng::rndU(int lo, int up)
 /* Returns a random integer:
  * lo = lower value,
  * up = upper value,
- * approximately uniform for up - lo << RAND_MAX.
+ * approximately uniform for up - lo << 2^53.
  */
 {
-    return lo + (int)((double)rand()/(double)RAND_MAX*(up - lo + 1));
+    return lo + (int)(rndDbl()*(up - lo + 1));
 }
 
-double rndDbl()
-/* Returns a random number between 0 and 1. */
+double Rng::rndDbl()
+/* Returns a random number in [0, 1). */
 {
-    return (double)rand()/RAND_MAX;
+    return (nxt() >> 11)*(1.0/9007199254740992.0);
 }
 
-int MdKP::invIdx(int j)
-/* Returns the inverse for the base class. */
+Prm::Prm()
+/* Default parameters. */
 {
-    return j;
+    se = DEFA_SE;
+    sz = DEFA_SZ;
+    mx = DEFA_MX;
+    tl = 0;
+    lpm = DEFA_LP;
+    wmx = DEFA_WMX;
+    alp = DEFA_ALP;
+    ep1 = DEFA_EP1;
+    ep2 = DEFA_EP2;
+    cki = DEFA_CKI;
+    rsm = false;
+    prf = false;
+    elt = DEFA_ELT;
+    edh = DEFA_EDH;
+    prw = DEFA_PRW;
+}
+
+string stpName(int stp)
+/* Returns the name of a stop reason. */
+{
+    if (stp == STP_TL)
+        return "time limit";
+    else if (stp == STP_CNC)
+        return "cancelled";
+    else if (stp == STP_ERR)
+        return "error";
+    else
+        return "iterations";
+}
+
+string lpName(int mth)
+/* Returns the name of a linear relaxation method. */
+{
+    if (mth == LP_DUL)
+        return "dual";
+    else if (mth == LP_PRE)
+        return "presolve+dual";
+    else
+        return "primal";
+}
+
+bool rdSol(string fn, int itms, vector<int> &x, string &err)
+/* Reads a solution file, the numbers (from 1) of the selected items separated by commas or white space as
+ * written by wrSol or output with sty = 1:
+ * itms = number of items,
+ * x = solution (variable values, output),
+ * err = error message (output).
+*/
+{
+    ifstream fs;
+    string tkn;
+    int j;
+    fs.open(fn);
+    if (!fs)
+    {
+        err = "Error opening file " + fn + ".";
+        return false;
+    }
+    x.assign(itms, 0);
+    while (fs >> tkn)
+    {
+        if (tkn.back() == ',')
+            tkn.pop_back();
+        j = atoi(tkn.c_str());
+        if (j < 1 || j > itms)
+        {
+            err = "Error reading " + fn + ": item " + tkn + ".";
+            return false;
+        }
+        x[j - 1] = 1;
+    }
+    return true;
 }
 
-bool MdKP::rdInt(string txt, int &i)
-/* Reads an integer from the file stream. */
+bool wrSol(string fn, const vector<int> &x, string &err)
+/* Writes a solution file (see rdSol). */
 {
-    if (pfs.eof())
+    ofstream fs;
+    int j;
+    bool aft;
+    fs.open(fn);
+    if (!fs)
     {
-        cout << "Error reading " << pfn << ": " << txt << "." << endl;
+        err = "Error opening file " + fn + ".";
+        return false;
+    }
+    aft = false;
+    for (j = 0; j < (int)x.size(); j++)
+        if (x[j] == 1)
+        {
+            if (aft)
+                fs << ", ";
+            fs << j + 1;
+            aft = true;
+        }
+    fs << endl;
+    return true;
+}
+
+bool MdKP::rdInt(istream &is, string txt, int &i)
+/* Reads an integer from a stream. */
+{
+    if (!(is >> i))
+    {
+        err = "Error reading " + pfn + ": " + txt + ".";
         return false;
     }
-    pfs >> i;
     return true;
 }
 
@@ -50,76 +175,143 @@ bool MdKP::clsFl(bool res)
     return res;
 }
 
-bool MdKP::rdPrb(string fn0)
-/* Reads a problem from a data file. */
+bool MdKP::rdPrb(istream &is, string nm)
+/* Reads a problem from a stream in the data file format:
+ * nm = name of the problem (for messages).
+*/
 {
     int i, j;
-    pfn = fn0;
-    pfs.open(pfn);
-    if (pfs)
+    pfn = nm;
+    err = "";
+    if (rdInt(is, "number of items", itms) && rdInt(is, "number of dimensions", dims)
+        && rdInt(is, "optimal value", opt))
     {
-        if (rdInt("number of items", itms) && rdInt("number of dimensions", dims) && rdInt("optimal value", opt))
+        if (itms < 1 || itms > N_MX || dims < 1 || dims > M_MX)
         {
-            for (j = 0; j < itms; j++)
-                if (!rdInt("value", val[j]))
-                    return clsFl(false);
-            for (i = 0; i < dims; i++)
-                for (j = 0; j < itms; j++)
-                    if (!rdInt("weight", wei[i][j]))
-                        return clsFl(false);
-            for (i = 0; i < dims; i++)
-                if (!rdInt("capacity", cap[i]))
-                    return clsFl(false);
-            return clsFl(true);
+            err = "Error reading " + pfn + ": size out of range.";
+            return false;
         }
-        else
-            return clsFl(false);
+        for (j = 0; j < itms; j++)
+            if (!rdInt(is, "value", val[j]))
+                return false;
+        for (i = 0; i < dims; i++)
+            for (j = 0; j < itms; j++)
+                if (!rdInt(is, "weight", wei[i][j]))
+                    return false;
+        for (i = 0; i < dims; i++)
+            if (!rdInt(is, "capacity", cap[i]))
+                return false;
+        return true;
     }
-    else
-        cout << "Error opening file " << pfn << "." << endl;
     return false;
 }
 
-void MdKP::uncrlPrb(int dims0, int itms0, int cap_lo, int cap_up, int val_lo, int val_up, int wei_lo, int wei_up)
+bool MdKP::rdPrb(string fn0)
+/* Reads a problem from a data file. */
+{
+    pfs.open(fn0);
+    if (pfs)
+        return clsFl(rdPrb(pfs, fn0));
+    err = "Error opening file " + fn0 + ".";
+    return false;
+}
+
+bool MdKP::mkPrb(int itms0, int dims0, const int val0[], const int wei0[], const int cap0[], int opt0)
+/* Creates a problem from arrays:
+ * val0 = values of items,
+ * wei0 = weights of items (row major, the weights for constraint i start at wei0[i*itms0]),
+ * cap0 = capacities,
+ * opt0 = optimum value (zero if not known).
+*/
+{
+    int i, j;
+    err = "";
+    if (itms0 < 1 || itms0 > N_MX || dims0 < 1 || dims0 > M_MX)
+    {
+        err = "size out of range";
+        return false;
+    }
+    itms = itms0;
+    dims = dims0;
+    opt = opt0;
+    for (j = 0; j < itms; j++)
+        val[j] = val0[j];
+    for (i = 0; i < dims; i++)
+    {
+        cap[i] = cap0[i];
+        for (j = 0; j < itms; j++)
+            wei[i][j] = wei0[i*itms + j];
+    }
+    return true;
+}
+
+MdKPS ldPrb(istream &is, string nm, string &err)
+/* Reads a problem from a stream into a new shared instance, returns null on error. */
+{
+    shared_ptr<MdKP> prb;
+    prb = make_shared<MdKP>();
+    if (!prb->rdPrb(is, nm))
+    {
+        err = prb->err;
+        return nullptr;
+    }
+    return prb;
+}
+
+MdKPS ldPrb(string fn, string &err)
+/* Reads a problem from a data file into a new shared instance, returns null on error. */
+{
+    shared_ptr<MdKP> prb;
+    prb = make_shared<MdKP>();
+    if (!prb->rdPrb(fn))
+    {
+        err = prb->err;
+        return nullptr;
+    }
+    return prb;
+}
+
+void MdKP::uncrlPrb(Rng &rnd, int dims0, int itms0, int cap_lo, int cap_up, int val_lo, int val_up, int wei_lo,
+    int wei_up)
 /* Creates a random uncorrelated (weights to profits) problem from the parameters passed. */
 {
     int i, j;
     dims = dims0;
     itms = itms0;
     for (i = 0; i < dims; i++)
-        cap[i] = rndU(cap_lo, cap_up);
+        cap[i] = rnd.rndU(cap_lo, cap_up);
     for (j = 0; j < itms; j++)
     {
-        val[j] = rndU(val_lo, val_up);
+        val[j] = rnd.rndU(val_lo, val_up);
         for (i = 0; i < dims; i++)
-            wei[i][j] = rndU(wei_lo, wei_up);
+            wei[i][j] = rnd.rndU(wei_lo, wei_up);
     }
 }
 
-void MdKP::crlPrb(int dims0, int itms0, int cap_lo, int cap_up, int wei0, double rng)
+void MdKP::crlPrb(Rng &rnd, int dims0, int itms0, int cap_lo, int cap_up, int wei0, double rng)
 /* Creates a random correlated problem from the parameters passed. */
 {
     int i, j, v_rng;
     dims = dims0;
     itms = itms0;
     for (i = 0; i < dims; i++)
-        cap[i] = rndU(cap_lo, cap_up);
+        cap[i] = rnd.rndU(cap_lo, cap_up);
     v_rng = (int)(wei0*rng);
     for (j = 0; j < itms; j++)
     {
-        val[j] = rndU(wei0 - v_rng, wei0 + v_rng);
+        val[j] = rnd.rndU(wei0 - v_rng, wei0 + v_rng);
         for (i = 0; i < dims; i++)
-            wei[i][j] = rndU(1, wei0);
+            wei[i][j] = rnd.rndU(1, wei0);
     }
 }
 
-void MdKP::outPrbSmry()
+void MdKP::outPrbSmry(ostream &os) const
 /* Outputs a problem summary. */
 {
-    cout << "m = " << dims << ", n = " << itms << endl;
+    os << "m = " << dims << ", n = " << itms << endl;
 }
 
-bool MdKP::feasSol()
+bool MdKP::feasSol(const int x[]) const
 /* Check solution is feasible. */
 {
     int i, j, c;
@@ -127,7 +319,7 @@ bool MdKP::feasSol()
     {
         c = cap[i];
         for (j = 0; j < itms; j++)
-            if (sol[j] == 1)
+            if (x[j] == 1)
                 c -= wei[i][j];
         if (c < 0)
             return false;
@@ -135,92 +327,135 @@ bool MdKP::feasSol()
     return true;
 }
 
-int MdKP::vSol()
+int MdKP::vSol(const int x[]) const
 /* Recalculates solution value. */
 {
     int j, r;
     r = 0;
     for (j = 0; j < itms; j++)
-        if (sol[j] == 1)
+        if (x[j] == 1)
             r += val[j];
     return r;
 }
 
-void MdKP::chk()
-/* Checks that the solution is feasible and that the value is correct. */
+MdKPV::MdKPV(MdKPS src0, const int idx0[])
+/* Builds the permuted copy of a problem:
+ * idx0 = source index of each permuted item.
+*/
 {
-    if (!feasSol())
-        cout << "infeasible" << endl;
-    if (v_sol != vSol())
-        cout << "mismatch" << endl;
+    int i, j, k, lo, up, nz;
+    src = src0;
+    itms = src->itms;
+    dims = src->dims;
+    lpm = DEFA_LP;
+    idx.assign(idx0, idx0 + itms);
+    inv.resize(itms);
+    val.resize(itms);
+    cap.assign(src->cap, src->cap + dims);
+    lo = 0;
+    up = 0;
+    nz = 0;
+    for (i = 0; i < dims; i++)
+        for (j = 0; j < itms; j++)
+        {
+            lo = min(lo, src->wei[i][j]);
+            up = max(up, src->wei[i][j]);
+            if (src->wei[i][j] != 0)
+                nz++;
+        }
+    // the sparse kernels count overused resources, which only holds for non-negative weights
+    spr = lo >= 0 && nz <= SPR_DNS*itms*dims;
+    wb = 4;
+    if (spr)
+    {
+        sst.resize(itms + 1);
+        sdm.reserve(nz);
+        swt.reserve(nz);
+    }
+    else if (lo >= 0 && up <= UINT8_MAX)
+    {
+        wb = 1;
+        wei8.resize(itms*dims);
+    }
+    else if (lo >= 0 && up <= UINT16_MAX)
+    {
+        wb = 2;
+        wei16.resize(itms*dims);
+    }
+    else
+        wei.resize(itms*dims);
+    for (j = 0; j < itms; j++)
+    {
+        k = idx[j];
+        val[j] = src->val[k];
+        if (spr)
+            sst[j] = sdm.size();
+        for (i = 0; i < dims; i++)
+            if (spr)
+            {
+                if (src->wei[i][k] != 0)
+                {
+                    sdm.push_back(i);
+                    swt.push_back(src->wei[i][k]);
+                }
+            }
+            else if (wb == 1)
+                wei8[j*dims + i] = src->wei[i][k];
+            else if (wb == 2)
+                wei16[j*dims + i] = src->wei[i][k];
+            else
+                wei[j*dims + i] = src->wei[i][k];
+        inv[k] = j;
+    }
+    if (spr)
+        sst[itms] = sdm.size();
 }
 
 int MdKPB::varIdx(int j)
-/* Variable index for base class. */
+/* Source index of variable j for base class. */
 {
     return j;
 }
 
-void MdKPB::outPrb()
-/* Outputs a problem. */
+int MdKPB::invIdx(int j)
+/* Variable index of source item j for base class. */
+{
+    return j;
+}
+
+void MdKPB::srcSol(vector<int> &x)
+/* Copies the solution in source order. */
+{
+    int j;
+    x.resize(itms);
+    for (j = 0; j < itms; j++)
+        x[j] = sol[invIdx(j)];
+}
+
+bool MdKPB::chk()
+/* Checks that the solution is feasible and that the value is correct. */
+{
+    vector<int> x;
+    srcSol(x);
+    return src->feasSol(x.data()) && v_sol == src->vSol(x.data());
+}
+
+void MdKPB::outPrb(ostream &os)
+/* Outputs a problem (in algorithm order). */
 {
     int i, j;
-    cout << "m = " << dims << ", n = " << itms << endl;
+    os << "m = " << dims << ", n = " << itms << endl;
     for (j = 0; j < itms; j++)
     {
-        cout << "p[" << j << "] = " << val[varIdx(j)];
+        os << "p[" << j << "] = " << src->val[varIdx(j)];
         if (j < itms - 1)
-            cout << ", ";
+            os << ", ";
     }
-    cout << endl;
+    os << endl;
     for (i = 0; i < dims; i++)
     {
         for (j = 0; j < itms; j++)
-            cout << "w[" << i << ", " << j << "] = " << wei[i][varIdx(j)] << ", ";
-        cout << "c[" << i << "] = " << cap[i] << endl;
-    }
-}
-
-void MdKPB::outSol()
-/* Outputs solution:
- * i = item index,
- * aft = flag set to true after first output.
-*/
-{
-    int i;
-    bool aft;
-    if (sty == STY_NONE)
-        return;
-    cout << "solution:" << endl;
-    aft = false;
-    for (i = 0; i < itms; i++)
-    {
-        if (sty == STY_BAS || sty == STY_BAS_X)
-        {
-            if (sol[invIdx(i)] == 1)
-            {
-                if (aft & !nwl)
-                    cout << ", ";
-                if (sty == STY_BAS_X)
-                    cout << "x";
-                cout << i + 1;
-                if (nwl)
-                    cout << endl;
-                aft = true;
-            }
-        }
-        else
-        {
-            if (aft & !nwl)
-                cout << ", ";
-            if (sty == STY_VAL_X)
-                cout << "x" << i + 1 << " = ";
-            cout << sol[invIdx(i)];
-            if (nwl)
-                cout << endl;
-            aft = true;
-        }
+            os << "w[" << i << ", " << j << "] = " << src->wei[i][varIdx(j)] << ", ";
+        os << "c[" << i << "] = " << src->cap[i] << endl;
     }
-    if (!nwl)
-        cout << endl;
 }
@@ -1,31 +1,180 @@
+#ifndef MDKP_H
+#define MDKP_H
+
 #include <string>
 #include <fstream>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
 
 using namespace std;
 
 typedef chrono::high_resolution_clock timer;
 typedef chrono::milliseconds millisecs;
+typedef chrono::duration<double, milli> millisecsD;
 typedef chrono::high_resolution_clock::time_point tm_pt;
 
-#define duration chrono::duration_cast<millisecs>
-
 #define M_MX 100
 #define N_MX 2500
 #define S_MX 20
-#define STY_NONE 0
-#define STY_BAS 1
-#define STY_BAS_X 2
-#define STY_VAL 3
-#define STY_VAL_X 4
+#define SPR_DNS 0.1
+#define LP_PRM 0
+#define LP_DUL 1
+#define LP_PRE 2
+#define STP_MX 0
+#define STP_TL 1
+#define STP_CNC 2
+#define STP_ERR 3
+#define PRF_PRP 0
+#define PRF_UPD 1
+#define PRF_REP 2
+#define PRF_LCL 3
+#define PRF_RGS 4
+#define PRF_CYC 0
+#define PRF_INS 1
+#define PRF_L1M 2
+#define PRF_LLM 3
+#define PRF_BRM 4
+#define PRF_CTS 5
+
+#define DEFA_SE 198671
+#define DEFA_SZ 20
+#define DEFA_MX 500
+#define DEFA_ALP 0.1
+#define DEFA_EP1 0.4
+#define DEFA_EP2 0.2
+#define DEFA_LP LP_PRM
+#define DEFA_WMX 100
+#define DEFA_CKI 100
+#define DEFA_ELT 0
+#define DEFA_EDH 2
+#define DEFA_PRW 0
+
+int calcMs(chrono::nanoseconds dur);
+double calcMsD(chrono::nanoseconds dur);
+string lpName(int mth);
+string stpName(int stp);
+string prfRg(int rg);
+string prfCt(int k);
+bool rdSol(string fn, int itms, vector<int> &x, string &err);
+bool wrSol(string fn, const vector<int> &x, string &err);
+
+class Rng
+/* Random number generator (splitmix64), each solver owns one so that solves are reentrant and repeatable:
+ * s = state.
+*/
+{
+public:
+    uint64_t s;
+    Rng(uint64_t se = DEFA_SE);
+    void srnd(uint64_t se);
+    uint64_t nxt();
+    int rndU(int lo, int up);
+    double rndDbl();
+};
 
-int calcMs(millisecs dur);
-int rndU(int lo, int up);
-double rndDbl();
+struct LPSt
+/* Linear relaxation statistics:
+ * mth = method (LP_PRM primal, LP_DUL dual, LP_PRE presolve and dual),
+ * tb = matrix build time (ms),
+ * ts = solve time (ms),
+ * its = simplex iterations,
+ * z = objective value (upper bound).
+*/
+{
+    int mth, its;
+    double tb, ts, z;
+};
+
+struct PrfSt
+/* Performance counts of the regions of a solve (PRF_PRP preparation, PRF_UPD quantum update, PRF_REP repair and
+ * greedy fill, PRF_LCL local search), each region counted exclusive of the regions inside it:
+ * on = true if counted,
+ * hw = true if the hardware counters were read (otherwise times only),
+ * tm = time in each region (ms),
+ * n = number of times each region was entered,
+ * c = counters in each region (PRF_CYC cycles, PRF_INS instructions, PRF_L1M L1 data read misses, PRF_LLM last
+ * level cache misses, PRF_BRM branch misses).
+*/
+{
+    bool on, hw;
+    double tm[PRF_RGS];
+    long long n[PRF_RGS];
+    uint64_t c[PRF_RGS][PRF_CTS];
+    PrfSt();
+    void add(const PrfSt &ps);
+};
+
+struct Prm
+/* Solver parameters (see the reference paper for alp, ep1 and ep2):
+ * se = random number seed,
+ * sz = population size,
+ * mx = maximum iterations,
+ * tl = time limit (ms, zero for none),
+ * lpm = linear relaxation method,
+ * wsol = warm start solution (source order, empty for a cold start),
+ * wmx = maximum iterations when warm started,
+ * wbas = CLP basis file the LP is warm started from (empty for none),
+ * sbas = file the CLP basis is saved to (empty for none),
+ * ckp = checkpoint file of the swarm state (empty for none),
+ * cki = iterations between checkpoints (a checkpoint is also written when the run ends),
+ * rsm = true to resume from ckp if it holds a checkpoint of the same problem, seed and population size,
+ * prf = true to count the regions of the solve (Res.prf),
+ * elt = size of the elite archive of the solve (zero for none), fed with the improved best solutions of the
+ * particles, pairs of its members are path relinked and a better solution found replaces the incumbent,
+ * edh = minimum Hamming distance between members of the elite archive,
+ * prw = path relinking worker threads (zero to relink one pair per iteration on the solving thread, which keeps
+ * the solve repeatable), the archive is not checkpointed.
+*/
+{
+    uint64_t se;
+    int sz, mx, tl, lpm, wmx, cki, elt, edh, prw;
+    double alp, ep1, ep2;
+    vector<int> wsol;
+    string wbas, sbas, ckp;
+    bool rsm, prf;
+    Prm();
+};
+
+struct Res
+/* Result of a solve:
+ * v = value of the best solution,
+ * x = best solution (variable values, source order),
+ * stp = stop reason (STP_MX iterations done, STP_TL time limit, STP_CNC cancelled, STP_ERR error),
+ * it = iterations done,
+ * tm = total time (ms),
+ * tmp = preparation time (ms, LP and sort, zero when a prepared view was reused),
+ * nwp = true if the view was prepared (and the LP solved) by this solve,
+ * lps = statistics of the linear relaxation of the view,
+ * prf = performance counts (if prm.prf),
+ * nrl = path relinkings done (if prm.elt > 0),
+ * nim = path relinkings that found a solution better than both ends,
+ * err = error message (stp = STP_ERR),
+ * wrn = warning messages.
+*/
+{
+    int v, stp, it, tm, tmp;
+    long long nrl, nim;
+    vector<int> x;
+    bool nwp;
+    LPSt lps;
+    PrfSt prf;
+    string err, wrn;
+};
+
+class Ckp;
+class Prf;
+class Elt;
+
+typedef function<void(int it, int v)> PrgCb;
+typedef function<bool()> CncCb;
+typedef function<int(int a[], int b[], int x[])> RlCb;
 
 class MdKP
-/* Class for Multidimensional Knapsack Problems:
+/* Class for Multidimensional Knapsack Problems, read only once loaded and shared between solvers through MdKPS:
  * pfn = problem filename (if needed),
  * pfs = file stream (if needed),
  * itms = number of items,
@@ -33,65 +182,171 @@ class MdKP
  * val = values of items,
  * wei = weights of items (for constraints),
  * cap = capacity of the knapsack,
- * sol = incumbent solution (variable values),
- * val_sol = value of incumbent solution,
- * opt = optimum value (read from file, zero if not known).
+ * opt = optimum value (read from file, zero if not known),
+ * err = error message of the last read.
 */
 {
 public:
-    string pfn;
+    string pfn, err;
     ifstream pfs;
-    int itms, dims, val[N_MX], wei[M_MX][N_MX], cap[M_MX], sol[N_MX], v_sol, opt;
-    virtual int invIdx(int i);
+    int itms, dims, val[N_MX], wei[M_MX][N_MX], cap[M_MX], opt;
     bool rdPrb(string fn0);
-    void uncrlPrb(int dims0, int itms0, int cap_lo, int cap_up, int val_lo, int val_up, int wei_lo, int wei_up);
-    void crlPrb(int dims0, int itms0, int cap_lo, int cap_up, int wei0, double rng);
-    void outPrbSmry();
-    bool feasSol();
-    int vSol();
-    void chk();
+    bool rdPrb(istream &is, string nm);
+    bool mkPrb(int itms0, int dims0, const int val0[], const int wei0[], const int cap0[], int opt0);
+    void uncrlPrb(Rng &rnd, int dims0, int itms0, int cap_lo, int cap_up, int val_lo, int val_up, int wei_lo,
+        int wei_up);
+    void crlPrb(Rng &rnd, int dims0, int itms0, int cap_lo, int cap_up, int wei0, double rng);
+    void outPrbSmry(ostream &os) const;
+    bool feasSol(const int x[]) const;
+    int vSol(const int x[]) const;
 private:
-    bool rdInt(string txt, int &i);
+    bool rdInt(istream &is, string txt, int &i);
     bool clsFl(bool res);
 };
 
-class MdKPB: public MdKP
-/* Abstract class for Multidimensional Knapsack Algorithm variants. */
+typedef shared_ptr<const MdKP> MdKPS;
+
+MdKPS ldPrb(string fn, string &err);
+MdKPS ldPrb(istream &is, string nm, string &err);
+
+class MdKPV
+/* Permuted view of a shared problem, a compact copy laid out for the hot loops of the algorithms:
+ * src = shared source problem,
+ * itms = number of items,
+ * dims = number of dimensions (constraints),
+ * idx = source index of each permuted item,
+ * inv = permuted index of each source item,
+ * val = values of items (permuted order),
+ * spr = true if the weights are stored sparse, chosen when at most SPR_DNS of them are nonzero and none negative,
+ * wb = bytes per stored weight (dense), the narrowest of 1, 2 or 4 that holds every weight,
+ * wei, wei16, wei8 = weights of items (dense, permuted order, item major: the weights of item j start at
+ * j*dims), only the array matching wb is filled,
+ * sst, sdm, swt = weights of items (sparse, permuted order, the nonzero weights of item j are swt[p] in
+ * dimensions sdm[p] for p from sst[j] to sst[j + 1] - 1),
+ * cap = capacity of the knapsack,
+ * dl = duals of the linear relaxation (one per constraint),
+ * lpm = linear relaxation method the view was prepared with (Prm.lpm, lps.mth may differ with a basis file), a
+ * solver with another method prepares its own view,
+ * lps = statistics of the linear relaxation solved to prepare the view.
+*/
+{
+public:
+    MdKPS src;
+    int itms, dims, wb, lpm;
+    bool spr;
+    vector<int> idx, inv, val, wei, cap, sst, sdm, swt;
+    vector<uint16_t> wei16;
+    vector<uint8_t> wei8;
+    vector<double> dl;
+    LPSt lps;
+    MdKPV(MdKPS src0, const int idx0[]);
+};
+
+typedef shared_ptr<const MdKPV> MdKPVS;
+
+struct Spr
+/* Weight type tag of the sparse kernels. */
+{
+};
+
+class MdKPB
+/* Abstract class for Multidimensional Knapsack Algorithm variants:
+ * src = shared problem being solved,
+ * itms = number of items,
+ * dims = number of dimensions (constraints),
+ * sol = incumbent solution (variable values, in algorithm order),
+ * v_sol = value of incumbent solution.
+*/
 {
 public:
-    int sty;
-    bool nwl;
+    MdKPS src;
+    int itms, dims, sol[N_MX], v_sol;
     virtual std::string name() = 0;
     virtual int varIdx(int j);
-    void outPrb();
-    void outSol();
+    virtual int invIdx(int j);
+    void srcSol(vector<int> &x);
+    void outPrb(ostream &os);
+    bool chk();
 };
 
 class MdKPQ: public MdKPB
-/* Hybrid Quantum Particle Swarm Optimisation Algorithm. */
+/* Hybrid Quantum Particle Swarm Optimisation Algorithm, reentrant: a solver has no shared state other than the
+ * read only problem and view, so separate solvers can run on separate threads:
+ * prm = parameters,
+ * prp = prepared (permuted) view of src, may be shared with other solvers of the same problem,
+ * rnd = random number generator,
+ * prg = progress callback (may be empty),
+ * cnc = cancellation callback (may be empty),
+ * t0 = start time of the solve,
+ * stp = stop reason,
+ * it = iterations done,
+ * err, wrn = error and warning messages of the solve,
+ * val, cap = the arrays of prp used by the hot loops (dense weights through wts),
+ * sst, sdm, swt = the sparse weight arrays of prp (if prp->spr),
+ * ys, xs, xt, vs = swarm state (kept between solves so the buffers are reused),
+ * ckw = checkpoint writer (while a solve with prm.ckp set runs),
+ * img = checkpoint image buffer,
+ * pf = performance counters (while a solve with prm.prf set runs),
+ * el = elite archive (if prm.elt > 0).
+*/
 {
 private:
-    int inv[N_MX], sz, mx;
-    double alp, bet, ep1, ep2, ep3;
-    bool prep(MdKP &src);
+    Prm prm;
+    double bet, ep3;
+    Rng rnd;
+    PrgCb prg;
+    CncCb cnc;
+    tm_pt t0;
+    int stp, it;
+    string err, wrn;
+    const int *val, *cap, *sst, *sdm, *swt;
+    vector<double> ys, yh;
+    vector<int> xs, xt, vs;
+    shared_ptr<Ckp> ckw;
+    vector<char> img;
+    shared_ptr<Prf> pf;
+    shared_ptr<Elt> el;
+    bool lp(vector<double> &dl_row, LPSt &lps);
+    bool prep(MdKPS src0);
+    bool stop();
+    uint64_t ckId();
+    void ckSv();
+    bool ckLd();
+    template<typename W> const W *wts();
+    template<typename W> bool fit(int k, int r[]);
+    template<typename W> void tk(int k, int r[]);
+    template<typename W> void rls(int k, int r[]);
+    template<typename W> bool inf(int r[]);
     int calV(int x[]);
     void cpy(int x[], int y[]);
-    void rmc(int x[], int r[]);
+    template<typename W> void rmc(int x[], int r[]);
     void cpyR(int s[], int t[]);
     void cpyD(double s[], double t[]);
-    bool inf(int r[]);
-    bool drp(int k, int x[], int r[], int &v);
-    void add(int k, int x[], int r[], int &v);
-    void lcl(int x[], int &v);
-    void algS(int s[], int t[], int &vi);
-    void alg();
+    template<typename W> bool drp(int k, int x[], int r[], int &v);
+    template<typename W> void add(int k, int x[], int r[], int &v);
+    template<typename W> void lcl(int x[], int &v);
+    template<typename W> int prl(int a[], int b[], int x[]);
+    RlCb rlf();
+    template<typename W> void algS(int s[], int t[], int &vi);
+    template<typename W> void algI();
+    template<typename W> void algK(int mxi);
+    template<typename W> void alg(bool ini0, int mxi);
+    void alg(bool ini0, int mxi);
+    bool stt(MdKPS src0, Res &res);
+    void itr(int mxi);
+    void fin(Res &res);
 public:
-    int tm;
+    MdKPVS prp;
     std::string name()
     {
         return "hybrid quantum particle swarm optimisation algorithm";
     }
-    void info();
-    void ini(int sz0, int mx0, double alp0, double ep10, double ep20, bool out, int sty0, bool nwl0);
-    int slv(MdKP &src, bool out);
+    int varIdx(int j);
+    int invIdx(int j);
+    void ini(const Prm &prm0);
+    Res slv(MdKPS src0, PrgCb prg0 = nullptr, CncCb cnc0 = nullptr);
+    Res bgn(MdKPS src0);
+    Res cnt(int k, PrgCb prg0 = nullptr, CncCb cnc0 = nullptr);
 };
+
+#endif
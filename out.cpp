@@ -0,0 +1,378 @@
+#include <cstdio>
+#include <cmath>
+#include <iomanip>
+#include "out.h"
+
+Snk::Snk(int sty0, bool nwl0, int sfm0)
+{
+    sty = sty0;
+    nwl = nwl0;
+    sfm = sfm0;
+    os << fixed << setprecision(OUT_PREC);
+}
+
+Snk::~Snk()
+{
+    flsh();
+}
+
+void Snk::msg(const string &s)
+/* Outputs a human readable message, ignored by machine readable sinks. */
+{
+}
+
+void Snk::prf(const string &prb, int rn, const PrfSt &ps)
+/* Outputs the performance counts of run rn (zero for the total of the runs of a problem). */
+{
+}
+
+void Snk::flsh()
+/* Writes the buffer to stdout in one piece. */
+{
+    string s;
+    s = os.str();
+    if (s.size() > 0)
+    {
+        fwrite(s.data(), 1, s.size(), stdout);
+        fflush(stdout);
+        os.str("");
+    }
+}
+
+void Snk::full()
+/* Flushes the buffer if it is full. */
+{
+    if (os.tellp() >= OUT_BUF)
+        flsh();
+}
+
+void Snk::sol(const vector<int> &x, const char *sep)
+/* Outputs a solution as the numbers (from 1) of the selected items separated by sep, or as a bitmap in hex where
+ * each digit holds 4 items, the first item in the most significant bit.
+*/
+{
+    static const char hx[] = "0123456789abcdef";
+    int j, k, d;
+    bool aft;
+    if (sfm == SFM_BMP)
+    {
+        for (j = 0; j < (int)x.size(); j += 4)
+        {
+            d = 0;
+            for (k = 0; k < 4; k++)
+                d = d << 1 | (j + k < (int)x.size() && x[j + k] == 1);
+            os << hx[d];
+        }
+        return;
+    }
+    aft = false;
+    for (j = 0; j < (int)x.size(); j++)
+        if (x[j] == 1)
+        {
+            if (aft)
+                os << sep;
+            os << j + 1;
+            aft = true;
+        }
+}
+
+SnkT::SnkT(int sty0, bool nwl0, int sfm0): Snk(sty0, nwl0, sfm0)
+{
+}
+
+void SnkT::msg(const string &s)
+{
+    os << s << "\n";
+    full();
+}
+
+void SnkT::err(const string &prb, const string &s)
+{
+    msg(s);
+}
+
+void SnkT::outSol(const vector<int> &x)
+/* Outputs solution:
+ * x = solution (source order),
+ * i = item index,
+ * aft = flag set to true after first output.
+*/
+{
+    int i;
+    bool aft;
+    if (sty == STY_NONE)
+        return;
+    os << "solution:" << "\n";
+    aft = false;
+    for (i = 0; i < (int)x.size(); i++)
+    {
+        if (sty == STY_BAS || sty == STY_BAS_X)
+        {
+            if (x[i] == 1)
+            {
+                if (aft & !nwl)
+                    os << ", ";
+                if (sty == STY_BAS_X)
+                    os << "x";
+                os << i + 1;
+                if (nwl)
+                    os << "\n";
+                aft = true;
+            }
+        }
+        else
+        {
+            if (aft & !nwl)
+                os << ", ";
+            if (sty == STY_VAL_X)
+                os << "x" << i + 1 << " = ";
+            os << x[i];
+            if (nwl)
+                os << "\n";
+            aft = true;
+        }
+    }
+    if (!nwl)
+        os << "\n";
+}
+
+void SnkT::run(const string &prb, int rn, uint64_t se, int opt, const Res &res)
+{
+    os << "run " << rn << "\n";
+    if (res.wrn != "")
+        os << res.wrn << "\n";
+    if (res.nwp)
+        os << "lp = " << lpName(res.lps.mth) << ", lpz = " << res.lps.z << ", lpi = " << res.lps.its << ", lpb = "
+            << res.lps.tb << ", lps = " << res.lps.ts << " ms" << "\n";
+    os << "z = " << res.v << (res.v == opt ? " (opt)" : "") << ", tm = " << res.tm << " ms" << "\n";
+    if (res.nrl > 0)
+        os << "nrl = " << res.nrl << ", nim = " << res.nim << "\n";
+    outSol(res.x);
+    full();
+}
+
+void SnkT::inst(const string &prb, int rns, int bst, double avg, int tm, int opt)
+{
+    os << "bst = " << bst << ", avg = " << avg << ", tm = " << tm << ", atm = " << (double)tm/rns << " ms" << "\n";
+    full();
+}
+
+void SnkT::prf(const string &prb, int rn, const PrfSt &ps)
+{
+    int r, k;
+    os << (rn > 0 ? "run " + to_string(rn) : string("all runs")) << " counts"
+        << (ps.hw ? "" : " (times only)") << ":\n";
+    for (r = 0; r < PRF_RGS; r++)
+    {
+        os << prfRg(r) << ": tm = " << ps.tm[r] << " ms, n = " << ps.n[r];
+        if (ps.hw)
+        {
+            for (k = 0; k < PRF_CTS; k++)
+                os << ", " << prfCt(k) << " = " << ps.c[r][k];
+            os << ", ipc = " << (ps.c[r][PRF_CYC] > 0 ? (double)ps.c[r][PRF_INS]/ps.c[r][PRF_CYC] : 0);
+        }
+        os << "\n";
+    }
+    full();
+}
+
+SnkJ::SnkJ(int sty0, bool nwl0, int sfm0): Snk(sty0, nwl0, sfm0)
+{
+}
+
+void SnkJ::str(const string &s)
+/* Outputs a JSON string. */
+{
+    static const char hx[] = "0123456789abcdef";
+    os << '"';
+    for (unsigned char c: s)
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (c < 0x20)
+            os << "\\u00" << hx[c >> 4] << hx[c & 15];
+        else
+            os << c;
+    os << '"';
+}
+
+void SnkJ::num(double d)
+/* Outputs a JSON number, null if d is not finite (JSON has no inf or nan). */
+{
+    if (isfinite(d))
+        os << d;
+    else
+        os << "null";
+}
+
+void SnkJ::err(const string &prb, const string &s)
+{
+    os << "{\"rec\":\"err\",\"prb\":";
+    str(prb);
+    os << ",\"err\":";
+    str(s);
+    os << "}\n";
+    full();
+}
+
+void SnkJ::run(const string &prb, int rn, uint64_t se, int opt, const Res &res)
+{
+    os << "{\"rec\":\"run\",\"prb\":";
+    str(prb);
+    os << ",\"run\":" << rn << ",\"se\":" << se << ",\"z\":" << res.v << ",\"opt\":" << opt << ",\"tm\":" << res.tm
+        << ",\"tmp\":" << res.tmp << ",\"it\":" << res.it << ",\"stp\":";
+    str(stpName(res.stp));
+    os << ",\"lp\":";
+    str(lpName(res.lps.mth));
+    os << ",\"lpz\":";
+    num(res.lps.z);
+    os << ",\"lpi\":" << res.lps.its << ",\"lpb\":";
+    num(res.lps.tb);
+    os << ",\"lps\":";
+    num(res.lps.ts);
+    os << ",\"wrn\":";
+    str(res.wrn);
+    os << ",\"n\":" << res.x.size();
+    if (res.nrl > 0)
+        os << ",\"nrl\":" << res.nrl << ",\"nim\":" << res.nim;
+    if (sfm == SFM_BMP)
+    {
+        os << ",\"bmp\":\"";
+        sol(res.x, "");
+        os << "\"";
+    }
+    else
+    {
+        os << ",\"sol\":[";
+        sol(res.x, ",");
+        os << "]";
+    }
+    os << "}\n";
+    full();
+}
+
+void SnkJ::inst(const string &prb, int rns, int bst, double avg, int tm, int opt)
+{
+    os << "{\"rec\":\"inst\",\"prb\":";
+    str(prb);
+    os << ",\"rns\":" << rns << ",\"bst\":" << bst << ",\"avg\":";
+    num(avg);
+    os << ",\"opt\":" << opt << ",\"tm\":" << tm << ",\"atm\":";
+    num((double)tm/rns);
+    os << "}\n";
+    full();
+}
+
+void SnkJ::prf(const string &prb, int rn, const PrfSt &ps)
+{
+    int r, k;
+    os << "{\"rec\":\"prf\",\"prb\":";
+    str(prb);
+    os << ",\"run\":" << rn << ",\"hw\":" << (ps.hw ? "true" : "false");
+    for (r = 0; r < PRF_RGS; r++)
+    {
+        os << ",";
+        str(prfRg(r));
+        os << ":{\"tm\":";
+        num(ps.tm[r]);
+        os << ",\"n\":" << ps.n[r];
+        if (ps.hw)
+            for (k = 0; k < PRF_CTS; k++)
+                os << ",\"" << prfCt(k) << "\":" << ps.c[r][k];
+        os << "}";
+    }
+    os << "}\n";
+    full();
+}
+
+SnkC::SnkC(int sty0, bool nwl0, int sfm0): Snk(sty0, nwl0, sfm0)
+{
+    hdr = false;
+}
+
+void SnkC::head()
+/* Outputs the header line before the first record. */
+{
+    if (!hdr)
+        os << "rec,prb,run,se,z,opt,tm,tmp,it,stp,lp,lpz,lpi,lpb,lps,rns,bst,avg,atm,err,wrn,sol\n";
+    hdr = true;
+}
+
+void SnkC::str(const string &s)
+/* Outputs a CSV field, quoted if needed. */
+{
+    if (s.find_first_of(",\"\n") == string::npos)
+    {
+        os << s;
+        return;
+    }
+    os << '"';
+    for (char c: s)
+    {
+        if (c == '"')
+            os << '"';
+        os << c;
+    }
+    os << '"';
+}
+
+void SnkC::num(double d)
+/* Outputs a number field, empty if d is not finite. */
+{
+    if (isfinite(d))
+        os << d;
+}
+
+void SnkC::err(const string &prb, const string &s)
+{
+    head();
+    os << "err,";
+    str(prb);
+    os << ",,,,,,,,,,,,,,,,,,";
+    str(s);
+    os << ",,\n";
+    full();
+}
+
+void SnkC::run(const string &prb, int rn, uint64_t se, int opt, const Res &res)
+{
+    head();
+    os << "run,";
+    str(prb);
+    os << "," << rn << "," << se << "," << res.v << "," << opt << "," << res.tm << "," << res.tmp << "," << res.it
+        << "," << stpName(res.stp) << "," << lpName(res.lps.mth) << ",";
+    num(res.lps.z);
+    os << "," << res.lps.its << ",";
+    num(res.lps.tb);
+    os << ",";
+    num(res.lps.ts);
+    os << ",,,,,,";
+    str(res.wrn);
+    os << ",";
+    sol(res.x, " ");
+    os << "\n";
+    full();
+}
+
+void SnkC::inst(const string &prb, int rns, int bst, double avg, int tm, int opt)
+{
+    head();
+    os << "inst,";
+    str(prb);
+    os << ",,,," << opt << "," << tm << ",,,,,,,,," << rns << "," << bst << ",";
+    num(avg);
+    os << ",";
+    num((double)tm/rns);
+    os << ",,,\n";
+    full();
+}
+
+unique_ptr<Snk> mkSnk(int fmt, int sty, bool nwl, int sfm)
+/* Creates a sink for an output format. */
+{
+    if (fmt == FMT_JSL)
+        return unique_ptr<Snk>(new SnkJ(sty, nwl, sfm));
+    else if (fmt == FMT_CSV)
+        return unique_ptr<Snk>(new SnkC(sty, nwl, sfm));
+    else
+        return unique_ptr<Snk>(new SnkT(sty, nwl, sfm));
+}
@@ -0,0 +1,89 @@
+#include <sstream>
+#include "mdkp.h"
+
+#define FMT_TXT 0
+#define FMT_JSL 1
+#define FMT_CSV 2
+#define SFM_IDX 0
+#define SFM_BMP 1
+#define STY_NONE 0
+#define STY_BAS 1
+#define STY_BAS_X 2
+#define STY_VAL 3
+#define STY_VAL_X 4
+#define OUT_BUF 1048576
+#define OUT_PREC 2
+
+class Snk
+/* Result sink, records are rendered into a buffer which is written to stdout once per batch (flsh) or when it
+ * grows past OUT_BUF:
+ * os = buffer,
+ * sty = solution output style (text),
+ * nwl = new lines between solution outputs (text),
+ * sfm = solution format (SFM_IDX numbers of the selected items, SFM_BMP bitmap).
+*/
+{
+public:
+    ostringstream os;
+    int sty, sfm;
+    bool nwl;
+    Snk(int sty0, bool nwl0, int sfm0);
+    virtual ~Snk();
+    virtual void msg(const string &s);
+    virtual void err(const string &prb, const string &s) = 0;
+    virtual void run(const string &prb, int rn, uint64_t se, int opt, const Res &res) = 0;
+    virtual void inst(const string &prb, int rns, int bst, double avg, int tm, int opt) = 0;
+    virtual void prf(const string &prb, int rn, const PrfSt &ps);
+    void flsh();
+protected:
+    void full();
+    void sol(const vector<int> &x, const char *sep);
+};
+
+class SnkT: public Snk
+/* Human readable text. */
+{
+public:
+    SnkT(int sty0, bool nwl0, int sfm0);
+    void msg(const string &s);
+    void err(const string &prb, const string &s);
+    void run(const string &prb, int rn, uint64_t se, int opt, const Res &res);
+    void inst(const string &prb, int rns, int bst, double avg, int tm, int opt);
+    void prf(const string &prb, int rn, const PrfSt &ps);
+private:
+    void outSol(const vector<int> &x);
+};
+
+class SnkJ: public Snk
+/* JSON Lines, one object per record with a "rec" member of "run", "inst", "prf" or "err". */
+{
+public:
+    SnkJ(int sty0, bool nwl0, int sfm0);
+    void err(const string &prb, const string &s);
+    void run(const string &prb, int rn, uint64_t se, int opt, const Res &res);
+    void inst(const string &prb, int rns, int bst, double avg, int tm, int opt);
+    void prf(const string &prb, int rn, const PrfSt &ps);
+private:
+    void str(const string &s);
+    void num(double d);
+};
+
+class SnkC: public Snk
+/* CSV, a header line then one row per record (run, inst or err), unused columns are empty, performance counts
+ * are not output:
+ * hdr = true once the header is written.
+*/
+{
+public:
+    SnkC(int sty0, bool nwl0, int sfm0);
+    void err(const string &prb, const string &s);
+    void run(const string &prb, int rn, uint64_t se, int opt, const Res &res);
+    void inst(const string &prb, int rns, int bst, double avg, int tm, int opt);
+private:
+    bool hdr;
+    void head();
+    void str(const string &s);
+    void num(double d);
+};
+
+unique_ptr<Snk> mkSnk(int fmt, int sty, bool nwl, int sfm);
@@ -0,0 +1,166 @@
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "prf.h"
+
+int opnCt(int k, int grp)
+/* Opens counter k of the calling thread in group grp (-1 for a new group), returns the descriptor or -1. */
+{
+    perf_event_attr pa;
+    memset(&pa, 0, sizeof(pa));
+    pa.size = sizeof(pa);
+    pa.type = PERF_TYPE_HARDWARE;
+    if (k == PRF_CYC)
+        pa.config = PERF_COUNT_HW_CPU_CYCLES;
+    else if (k == PRF_INS)
+        pa.config = PERF_COUNT_HW_INSTRUCTIONS;
+    else if (k == PRF_L1M)
+    {
+        pa.type = PERF_TYPE_HW_CACHE;
+        pa.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+    else if (k == PRF_LLM)
+        pa.config = PERF_COUNT_HW_CACHE_MISSES;
+    else
+        pa.config = PERF_COUNT_HW_BRANCH_MISSES;
+    pa.disabled = grp == -1;
+    pa.exclude_kernel = 1;
+    pa.exclude_hv = 1;
+    pa.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open, &pa, 0, -1, grp, 0);
+}
+
+PrfSt::PrfSt()
+{
+    on = false;
+    hw = false;
+    memset(tm, 0, sizeof(tm));
+    memset(n, 0, sizeof(n));
+    memset(c, 0, sizeof(c));
+}
+
+void PrfSt::add(const PrfSt &ps)
+/* Adds the counts of another solve. */
+{
+    int r, k;
+    on = on || ps.on;
+    hw = hw || ps.hw;
+    for (r = 0; r < PRF_RGS; r++)
+    {
+        tm[r] += ps.tm[r];
+        n[r] += ps.n[r];
+        for (k = 0; k < PRF_CTS; k++)
+            c[r][k] += ps.c[r][k];
+    }
+}
+
+string prfRg(int rg)
+/* Returns the name of a region. */
+{
+    if (rg == PRF_PRP)
+        return "prep";
+    else if (rg == PRF_UPD)
+        return "update";
+    else if (rg == PRF_REP)
+        return "repair";
+    else
+        return "local";
+}
+
+string prfCt(int k)
+/* Returns the name of a counter. */
+{
+    if (k == PRF_CYC)
+        return "cyc";
+    else if (k == PRF_INS)
+        return "ins";
+    else if (k == PRF_L1M)
+        return "l1m";
+    else if (k == PRF_LLM)
+        return "llm";
+    else
+        return "brm";
+}
+
+Prf::Prf()
+/* Opens the counters, falls back to times only if the group leader (cycles) cannot be opened, a counter the
+ * hardware does not have reads zero.
+*/
+{
+    int k;
+    st.on = true;
+    ng = 0;
+    dp = 0;
+    for (k = 0; k < PRF_CTS; k++)
+    {
+        fd[k] = opnCt(k, k == PRF_CYC ? -1 : fd[PRF_CYC]);
+        gi[k] = fd[k] >= 0 ? ng++ : -1;
+        lc[k] = 0;
+        if (k == PRF_CYC && fd[k] < 0)
+        {
+            err = string("hardware counters not available (") + strerror(errno) + "), times only";
+            break;
+        }
+    }
+    st.hw = fd[PRF_CYC] >= 0;
+    if (st.hw)
+    {
+        ioctl(fd[PRF_CYC], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd[PRF_CYC], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    smp();
+}
+
+Prf::~Prf()
+{
+    int k;
+    if (st.hw)
+        for (k = PRF_CTS - 1; k >= 0; k--)
+            if (fd[k] >= 0)
+                close(fd[k]);
+}
+
+void Prf::smp()
+/* Reads the counters and the time, adds the change since the last boundary to the innermost open region. */
+{
+    uint64_t buf[PRF_CTS + 1], v;
+    tm_pt t;
+    int k, r;
+    t = timer::now();
+    r = dp > 0 && dp <= PRF_DPT ? stk[dp - 1] : -1;
+    if (r >= 0)
+        st.tm[r] += calcMsD(t - lt);
+    lt = t;
+    if (!st.hw || read(fd[PRF_CYC], buf, sizeof(buf)) <= 0)
+        return;
+    for (k = 0; k < PRF_CTS; k++)
+        if (gi[k] >= 0 && gi[k] < (int)buf[0])
+        {
+            v = buf[gi[k] + 1];
+            if (r >= 0)
+                st.c[r][k] += v - lc[k];
+            lc[k] = v;
+        }
+}
+
+void Prf::bgn(int rg)
+/* Opens a region. */
+{
+    smp();
+    if (dp < PRF_DPT)
+        stk[dp] = rg;
+    dp++;
+    st.n[rg]++;
+}
+
+void Prf::end()
+/* Closes the innermost region. */
+{
+    smp();
+    if (dp > 0)
+        dp--;
+}
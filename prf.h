@@ -0,0 +1,53 @@
+#ifndef PRF_H
+#define PRF_H
+
+#include "mdkp.h"
+
+#define PRF_DPT 8
+
+class Prf
+/* Performance counters of the calling thread (Linux perf_event_open, user space only) read at the boundaries of
+ * scoped regions, the counts between two boundaries go to the innermost open region so that nested regions are
+ * counted exclusively, with times only if the kernel does not allow the counters:
+ * st = counts (output),
+ * fd = counter file descriptors (-1 if not open), fd[PRF_CYC] leads the group,
+ * gi = position of each counter in a group read (-1 if not open),
+ * ng = number of counters in the group,
+ * lc, lt = counter values and time at the last boundary,
+ * stk, dp = stack of open regions and its depth,
+ * err = reason the hardware counters are not used.
+*/
+{
+public:
+    PrfSt st;
+    string err;
+    Prf();
+    ~Prf();
+    void bgn(int rg);
+    void end();
+private:
+    int fd[PRF_CTS], gi[PRF_CTS], ng, stk[PRF_DPT], dp;
+    uint64_t lc[PRF_CTS];
+    tm_pt lt;
+    void smp();
+};
+
+class PrfR
+/* Scoped region, does nothing if pf is null. */
+{
+public:
+    Prf *pf;
+    PrfR(Prf *pf0, int rg)
+    {
+        pf = pf0;
+        if (pf)
+            pf->bgn(rg);
+    }
+    ~PrfR()
+    {
+        if (pf)
+            pf->end();
+    }
+};
+
+#endif
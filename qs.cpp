@@ -1,93 +1,260 @@
 #include <climits>
+#include <cstring>
+#include <algorithm>
 #include "ClpSimplex.hpp"
+#include "ClpSolve.hpp"
 #include "mdkp.h"
 #include "srt.h"
+#include "ckp.h"
+#include "prf.h"
+#include "elt.h"
 
-bool MdKPQ::prep(MdKP &src)
-/* Uses Coin-OR CLP to solve the linear relaxation, uses the dual solution (shadow prices) to calculate the utility
- * value of each item and finally sorts the items by decreasing utility value:
- * n = number of elements in LP matrix,
+bool MdKPQ::lp(vector<double> &dl_row, LPSt &lps)
+/* Uses Coin-OR CLP to solve the linear relaxation of src with the method prm.lpm, the matrix is built column
+ * ordered straight from the problem with zero weights dropped, the basis is imported from prm.wbas and saved to
+ * prm.sbas if set:
+ * dl_row = dual (solution) row values (output),
+ * lps = statistics (output),
  * elts = element values in LP matrix,
+ * row_idc = row indices for LP matrix,
+ * col_st = column starts in LP matrix,
+ * col_ln = column lengths in LP matrix,
  * obj = objective values in LP (item values in MdKP),
  * col_lwr = column lower values,
  * col_upr = column upper values,
  * row_upr = row upper values,
- * utl = utility values of each item,
+ * i, j = index variables.
+*/
+{
+    ClpSimplex mdl;
+    ClpSolve opts;
+    tm_pt t0, t1, t2;
+    vector<double> elts, obj(itms), col_lwr(itms, 0), col_upr(itms, 1), row_upr(dims);
+    vector<int> row_idc, col_st(itms), col_ln(itms);
+    int i, j, mth;
+    t0 = timer::now();
+    for (j = 0; j < itms; j++)
+    {
+        col_st[j] = elts.size();
+        for (i = 0; i < dims; i++)
+            if (src->wei[i][j] != 0)
+            {
+                elts.push_back(src->wei[i][j]);
+                row_idc.push_back(i);
+            }
+        col_ln[j] = elts.size() - col_st[j];
+        obj[j] = src->val[j];
+    }
+    for (i = 0; i < dims; i++)
+        row_upr[i] = src->cap[i];
+    CoinPackedMatrix mat(true, dims, itms, elts.size(), elts.data(), row_idc.data(), col_st.data(), col_ln.data());
+    mdl.setLogLevel(0);
+    mdl.loadProblem(mat, col_lwr.data(), col_upr.data(), obj.data(), NULL, row_upr.data());
+    mdl.setOptimizationDirection(-1);
+    mth = prm.lpm;
+    if (prm.wbas != "")
+    {
+        // presolve would discard the imported basis so warm starts use the dual simplex instead
+        if (mdl.readBasis(prm.wbas.c_str()) < 0)
+            wrn += "error reading basis " + prm.wbas + ", solving LP from scratch; ";
+        else if (mth == LP_PRE)
+            mth = LP_DUL;
+    }
+    t1 = timer::now();
+    if (mth == LP_DUL)
+        mdl.dual();
+    else if (mth == LP_PRE)
+    {
+        opts.setSolveType(ClpSolve::useDual);
+        opts.setPresolveType(ClpSolve::presolveOn);
+        mdl.initialSolve(opts);
+    }
+    else
+        mdl.primal();
+    t2 = timer::now();
+    lps.mth = mth;
+    lps.tb = calcMsD(t1 - t0);
+    lps.ts = calcMsD(t2 - t1);
+    lps.its = mdl.numberIterations();
+    lps.z = mdl.objectiveValue();
+    if (!mdl.isProvenOptimal())
+    {
+        err = "error LP:";
+        if (mdl.isProvenPrimalInfeasible())
+            err += " proven primal infeasible";
+        if (mdl.isProvenDualInfeasible())
+            err += " proven dual infeasible";
+        if (mdl.isIterationLimitReached())
+            err += " iteration limit reached";
+        return false;
+    }
+    dl_row.assign(mdl.dualRowSolution(), mdl.dualRowSolution() + dims);
+    if (prm.sbas != "" && mdl.writeBasis(prm.sbas.c_str(), false, 0) != 0)
+        wrn += "error writing basis " + prm.sbas + "; ";
+    return true;
+}
+
+bool MdKPQ::prep(MdKPS src0)
+/* Solves the linear relaxation, uses the dual solution (shadow prices) to calculate the utility value of each item
+ * and finally sorts the items by decreasing utility value into a shared permuted view (prp), the view is reused
+ * if it was already prepared for the same problem with the same method:
  * dl_row = dual (solution) row values,
+ * utl = utility values of each item,
  * sum = a summation for calculating utility values,
- * row_idc = row indices for LP matrix,
- * col_idc = column indices for LP matrix,
- * i, j, k = index variables.
+ * idx = item indices sorted by utility,
+ * lps = LP statistics,
+ * i, j = index variables.
 */
 {
-	ClpSimplex  mdl;
-	int n;
-	dims = src.dims;
-	itms = src.itms;
-	opt = src.opt;
-	n = dims*itms;
-	double elts[n], obj[itms], col_lwr[itms], col_upr[itms], row_upr[dims], utl[itms], *dl_row, sum;
-	int row_idc[n], col_idc[n], idx[itms], i, j, k;
-	for (i = 0; i < dims; i++)
-		cap[i] = src.cap[i];
-	k = 0;
-	for (i = 0; i < dims; i++)
-	{
-		row_upr[i] = cap[i];
-		for (j = 0; j < itms; j++)
-		{
-			elts[k] = src.wei[i][j];
-			row_idc[k] = i;
-			col_idc[k++] = j;
-		}
-	}
-	for (j = 0; j < itms; j++)
-	{
-		obj[j] = src.val[j];
-		col_lwr[j] = 0;
-		col_upr[j] = 1;
-	}
-	CoinPackedMatrix mat(false, row_idc, col_idc, elts, n);
-	mdl.setLogLevel(0);
-	mdl.loadProblem(mat, col_lwr, col_upr, obj, NULL, row_upr);
-	mdl.setOptimizationDirection(-1);
-	mdl.primal();
-	if (mdl.isProvenOptimal())
-	{
-        dl_row = mdl.dualRowSolution();
+    src = src0;
+    itms = src->itms;
+    dims = src->dims;
+    if (prp == nullptr || prp->src != src || prp->lpm != prm.lpm)
+    {
+        vector<double> dl_row, utl(itms);
+        vector<int> idx(itms);
+        double sum;
+        int i, j;
+        LPSt lps;
+        shared_ptr<MdKPV> vw;
+        if (!lp(dl_row, lps))
+            return false;
         for (j = 0; j < itms; j++)
         {
             sum = 0;
             for (i = 0; i < dims; i++)
-                sum += dl_row[i]*src.wei[i][j];
-                // algorithm variation, try instead: sum += dl_row[i]*src.wei[i][j]/cap[i];
-            idx[j] = j;
-            utl[j] = src.val[j]/sum;
+                sum += dl_row[i]*src->wei[i][j];
+                // algorithm variation, try instead: sum += dl_row[i]*src->wei[i][j]/src->cap[i];
+            utl[j] = src->val[j]/sum;
         }
-        qSrt(idx, utl, 0, itms - 1);
-        for (j = 0; j < itms; j++)
-        {
-            k = idx[j];
-            val[j] = src.val[k];
-            for (i = 0; i < dims; i++)
-                wei[i][j] = src.wei[i][k];
-            inv[k] = j;
-        }
-        return true;
+        idxSrt(idx.data(), utl.data(), itms, true);
+        vw = make_shared<MdKPV>(src, idx.data());
+        vw->lps = lps;
+        vw->lpm = prm.lpm;
+        vw->dl = dl_row;
+        prp = vw;
     }
-    else
+    val = prp->val.data();
+    cap = prp->cap.data();
+    sst = prp->sst.data();
+    sdm = prp->sdm.data();
+    swt = prp->swt.data();
+    return true;
+}
+
+template<>
+const int *MdKPQ::wts<int>()
+/* Weights of the prepared view, full width. */
+{
+    return prp->wei.data();
+}
+
+template<>
+const uint16_t *MdKPQ::wts<uint16_t>()
+/* Weights of the prepared view, 16 bit. */
+{
+    return prp->wei16.data();
+}
+
+template<>
+const uint8_t *MdKPQ::wts<uint8_t>()
+/* Weights of the prepared view, 8 bit. */
+{
+    return prp->wei8.data();
+}
+
+template<typename W>
+bool MdKPQ::fit(int k, int r[])
+/* Returns true if item k fits in the remaining capacity r. */
+{
+    int i;
+    const W *w;
+    w = wts<W>() + k*dims;
+    for (i = 0; i < dims; i++)
+        if (w[i] > r[i])
+            return false;
+    return true;
+}
+
+template<typename W>
+void MdKPQ::tk(int k, int r[])
+/* Takes the weights of item k from the remaining capacity r. */
+{
+    int i;
+    const W *w;
+    w = wts<W>() + k*dims;
+    for (i = 0; i < dims; i++)
+        r[i] -= w[i];
+}
+
+template<typename W>
+void MdKPQ::rls(int k, int r[])
+/* Releases the weights of item k back to the remaining capacity r. */
+{
+    int i;
+    const W *w;
+    w = wts<W>() + k*dims;
+    for (i = 0; i < dims; i++)
+        r[i] += w[i];
+}
+
+template<typename W>
+bool MdKPQ::inf(int r[])
+/* Returns true if infeasible e.g. one or more resource is overused. */
+{
+    int i;
+    for (i = 0; i < dims; i++)
+        if (r[i] < 0)
+            return true;
+    return false;
+}
+
+template<>
+bool MdKPQ::fit<Spr>(int k, int r[])
+/* Returns true if item k fits, sparse: only the nonzero weights of k are looked at. */
+{
+    int p;
+    for (p = sst[k]; p < sst[k + 1]; p++)
+        if (swt[p] > r[sdm[p]])
+            return false;
+    return true;
+}
+
+template<>
+void MdKPQ::tk<Spr>(int k, int r[])
+/* Takes the weights of item k, sparse: r[dims] counts the overused resources. */
+{
+    int p, i;
+    for (p = sst[k]; p < sst[k + 1]; p++)
     {
-        cout << "error LP: " << endl;
-        if (mdl.isProvenPrimalInfeasible())
-            cout << "proven primal infeasible" << endl;
-        if (mdl.isProvenDualInfeasible())
-            cout << "proven dual infeasible" << endl;
-        if (mdl.isIterationLimitReached())
-            cout << "iteration limit reached" << endl;
-        return false;
+        i = sdm[p];
+        if (r[i] >= 0 && r[i] - swt[p] < 0)
+            r[dims]++;
+        r[i] -= swt[p];
+    }
+}
+
+template<>
+void MdKPQ::rls<Spr>(int k, int r[])
+/* Releases the weights of item k, sparse: r[dims] counts the overused resources. */
+{
+    int p, i;
+    for (p = sst[k]; p < sst[k + 1]; p++)
+    {
+        i = sdm[p];
+        if (r[i] < 0 && r[i] + swt[p] >= 0)
+            r[dims]--;
+        r[i] += swt[p];
     }
 }
 
+template<>
+bool MdKPQ::inf<Spr>(int r[])
+/* Returns true if infeasible, sparse: read from the count of overused resources. */
+{
+    return r[dims] > 0;
+}
+
 int MdKPQ::calV(int x[])
 /* Calculates value of a solution. */
 {
@@ -107,23 +274,30 @@ void MdKPQ::cpy(int x[], int y[])
         y[j] = x[j];
 }
 
+template<typename W>
 void MdKPQ::rmc(int x[], int r[])
-/* Calculates the remaining capacity. */
+/* Calculates the remaining capacity, r[dims] is the number of overused resources (kept up to date by the sparse
+ * kernels only).
+*/
 {
     int i, j;
+    r[dims] = 0;
     for (i = 0; i < dims; i++)
+    {
         r[i] = cap[i];
+        if (r[i] < 0)
+            r[dims]++;
+    }
     for (j = 0; j < itms; j++)
         if (x[j] == 1)
-            for (i = 0; i < dims; i++)
-                r[i] -= wei[i][j];
+            tk<W>(j, r);
 }
 
 void MdKPQ::cpyR(int s[], int t[])
-/* Copies the remaining capacity. */
+/* Copies the remaining capacity (with the count of overused resources). */
 {
     int i;
-    for (i = 0; i < dims; i++)
+    for (i = 0; i <= dims; i++)
         t[i] = s[i];
 }
 
@@ -135,76 +309,41 @@ void MdKPQ::cpyD(double s[], double t[])
         t[j] = s[j];
 }
 
-bool MdKPQ::inf(int r[])
-/* Returns true if infeasible e.g. one or more resource is overused. */
-{
-    int i;
-    bool flg;
-    flg = false;
-    for (i = 0; i < dims; i++)
-        if (r[i] < 0)
-        {
-            flg = true;
-            break;
-        }
-    return flg;
-}
-
+template<typename W>
 bool MdKPQ::drp(int k, int x[], int r[], int &v)
 /* Drop subroutine. */
 {
-    int i;
-    bool flg;
     if (x[k] == 1)
     {
         x[k] = 0;
-        for (i = 0; i < dims; i++)
-            r[i] += wei[i][k];
+        rls<W>(k, r);
         v -= val[k];
-        flg = true;
-        for (i = 0; i < dims; i++)
-            if (r[i] < 0)
-            {
-                flg = false;
-                break;
-            }
-        return flg;
+        return !inf<W>(r);
     }
     else
         return false;
 }
 
+template<typename W>
 void MdKPQ::add(int k, int x[], int r[], int &v)
 /* Add subroutine. */
 {
-    int i;
-    bool flg;
-    if (x[k] == 0)
+    if (x[k] == 0 && fit<W>(k, r))
     {
-        flg = true;
-        for (i = 0; i < dims; i++)
-            if (wei[i][k] > r[i])
-            {
-                flg = false;
-                break;
-            }
-        if (flg)
-        {
-            x[k] = 1;
-            for (i = 0; i < dims; i++)
-                r[i] -= wei[i][k];
-            v += val[k];
-        }
+        x[k] = 1;
+        tk<W>(k, r);
+        v += val[k];
     }
 }
 
+template<typename W>
 void MdKPQ::lcl(int x[], int &v)
 /* Local search. */
 {
-    int xl[N_MX], xd[N_MX], r[M_MX], rl[M_MX], rd[M_MX], vl, vd, i, j, k;
+    int xl[N_MX], xd[N_MX], r[M_MX + 1], rl[M_MX + 1], rd[M_MX + 1], vl, vd, j, k;
     bool imp;
     cpy(x, xl);
-    rmc(x, r);
+    rmc<W>(x, r);
     vl = v;
     imp = true;
     while (imp)
@@ -219,24 +358,22 @@ void MdKPQ::lcl(int x[], int &v)
             if (xd[j] == 1)
             {
                 xd[j] = 0;
-                for (i = 0; i < dims; i++)
-                    rd[i] += wei[i][j];
+                rls<W>(j, rd);
                 vd -= val[j];
                 // add phase:
                 for (k = 0; k < itms; k++)
                     if (k != j)
-                        add(k, xd, rd, vd);
+                        add<W>(k, xd, rd, vd);
             }
             else
             {
                 xd[j] = 1;
-                for (i = 0; i < dims; i++)
-                    rd[i] -= wei[i][j];
+                tk<W>(j, rd);
                 vd += val[j];
                 // drop phase:
-                if (inf(rd))
+                if (inf<W>(rd))
                     for (k = itms - 1; k >= 0; k--)
-                        if (k != j && drp(k, xd, rd, vd))
+                        if (k != j && drp<W>(k, xd, rd, vd))
                             break;
             }
             if (vd > vl)
@@ -256,23 +393,93 @@ void MdKPQ::lcl(int x[], int &v)
     }
 }
 
+template<typename W>
+int MdKPQ::prl(int a[], int b[], int x[])
+/* Path relinking from solution a towards solution b (both feasible), each step moves one item where the path
+ * differs from b: the most valuable add that fits or, if none fits, the least valuable drop, so the path stays
+ * feasible, the best point of the path (filled greedily) is improved by local search into x, returns its value (-1
+ * if a is b).
+*/
+{
+    int xc[N_MX], xf[N_MX], rc[M_MX + 1], rf[M_MX + 1], vc, vf, vx, j, ka, kd;
+    cpy(a, xc);
+    rmc<W>(xc, rc);
+    vc = calV(xc);
+    vx = -1;
+    while (true)
+    {
+        ka = -1;
+        kd = -1;
+        for (j = 0; j < itms; j++)
+            if (xc[j] != b[j])
+            {
+                if (xc[j] == 0)
+                {
+                    if ((ka < 0 || val[j] > val[ka]) && fit<W>(j, rc))
+                        ka = j;
+                }
+                else if (kd < 0 || val[j] < val[kd])
+                    kd = j;
+            }
+        if (ka >= 0)
+            add<W>(ka, xc, rc, vc);
+        else if (kd >= 0)
+            drp<W>(kd, xc, rc, vc);
+        else
+            break;
+        cpy(xc, xf);
+        cpyR(rc, rf);
+        vf = vc;
+        for (j = 0; j < itms; j++)
+            add<W>(j, xf, rf, vf);
+        if (vf > vx)
+        {
+            cpy(xf, x);
+            vx = vf;
+        }
+    }
+    if (vx >= 0)
+        lcl<W>(x, vx);
+    return vx;
+}
+
+RlCb MdKPQ::rlf()
+/* Returns the path relinking with the kernels for the weight storage of the prepared view. */
+{
+    if (prp->spr)
+        return [this](int a[], int b[], int x[]) { return prl<Spr>(a, b, x); };
+    else if (prp->wb == 1)
+        return [this](int a[], int b[], int x[]) { return prl<uint8_t>(a, b, x); };
+    else if (prp->wb == 2)
+        return [this](int a[], int b[], int x[]) { return prl<uint16_t>(a, b, x); };
+    else
+        return [this](int a[], int b[], int x[]) { return prl<int>(a, b, x); };
+}
+
+template<typename W>
 void MdKPQ::algS(int s[], int t[], int &vi)
 /* Algorithm subroutine. */
 {
-    int r[M_MX], k, v;
+    int r[M_MX + 1], k, v;
+    PrfR pr(pf.get(), PRF_REP);
     v = calV(s);
-    rmc(s, r);
-    if (inf(r))
+    rmc<W>(s, r);
+    if (inf<W>(r))
         for (k = itms - 1; k >= 0; k--)
-            if (drp(k, s, r, v))
+            if (drp<W>(k, s, r, v))
                 break;
     for (k = 0; k < itms; k++)
-        add(k, s, r, v);
+        add<W>(k, s, r, v);
     if (v > vi)
     {
-        lcl(s, v);
+        {
+            PrfR pl(pf.get(), PRF_LCL);
+            lcl<W>(s, v);
+        }
         cpy(s, t);
         vi = v;
+        if (el)
+            el->put(s, v);
         if (v > v_sol)
         {
             cpy(s, sol);
@@ -281,78 +488,395 @@ void MdKPQ::algS(int s[], int t[], int &vi)
     }
 }
 
-void MdKPQ::alg()
-/* Main algorithm. */
+bool MdKPQ::stop()
+/* Checks the time limit and the cancellation callback, sets the stop reason. */
+{
+    if (prm.tl > 0 && calcMs(timer::now() - t0) >= prm.tl)
+        stp = STP_TL;
+    else if (cnc && cnc())
+        stp = STP_CNC;
+    return stp != STP_MX;
+}
+
+uint64_t fnv(uint64_t h, uint64_t k)
+/* Adds a 64 bit word to an FNV-1a hash. */
+{
+    return (h ^ k)*0x100000001b3ull;
+}
+
+uint64_t MdKPQ::ckId()
+/* Returns a hash (FNV-1a) of the problem (values, weights and capacities), the order of the prepared view and the
+ * parameters alp, ep1 and ep2, a checkpoint only fits the problem, view and parameters it was taken with.
+*/
+{
+    double p[3] = {prm.alp, prm.ep1, prm.ep2};
+    uint64_t h, b;
+    int i, j;
+    h = 0xcbf29ce484222325ull;
+    for (j = 0; j < itms; j++)
+        h = fnv(fnv(h, (uint32_t)prp->idx[j]), (uint32_t)src->val[j]);
+    for (i = 0; i < dims; i++)
+    {
+        h = fnv(h, (uint32_t)src->cap[i]);
+        for (j = 0; j < itms; j++)
+            h = fnv(h, (uint32_t)src->wei[i][j]);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        memcpy(&b, &p[i], sizeof(b));
+        h = fnv(h, b);
+    }
+    return h;
+}
+
+void MdKPQ::ckSv()
+/* Takes an image of the state at the end of an iteration and hands it to the checkpoint writer:
+ * header = magic, version, items, dimensions, population size, seed, view hash, iterations, incumbent value, random
+ * number generator state,
+ * then sol, vs, xt (bytes) and ys.
+*/
+{
+    vector<char> b(itms);
+    int hd[5] = {CKP_MAG, CKP_VER, itms, dims, prm.sz};
+    uint64_t id[3] = {prm.se, ckId(), rnd.s};
+    int j;
+    img.clear();
+    ckW(img, hd, 5);
+    ckW(img, id, 3);
+    ckW(img, &it, 1);
+    ckW(img, &v_sol, 1);
+    for (j = 0; j < itms; j++)
+        b[j] = sol[j];
+    ckW(img, b.data(), itms);
+    ckW(img, vs.data(), prm.sz);
+    b.resize(prm.sz*itms);
+    for (j = 0; j < prm.sz*itms; j++)
+        b[j] = xt[j];
+    ckW(img, b.data(), prm.sz*itms);
+    ckW(img, ys.data(), prm.sz*itms);
+    ckw->put(img);
+}
+
+bool MdKPQ::ckLd()
+/* Restores the state from the checkpoint file prm.ckp, returns false (with a warning if the file is there) if it
+ * does not fit this solve.
+*/
+{
+    vector<char> b;
+    size_t at;
+    int hd[5], it0, v0, j;
+    uint64_t id[3];
+    if (!rdCkp(prm.ckp, img))
+        return false;
+    at = 0;
+    if (!ckR(img, at, hd, 5) || !ckR(img, at, id, 3) || hd[0] != CKP_MAG || hd[1] != CKP_VER || hd[2] != itms
+        || hd[3] != dims || hd[4] != prm.sz || id[0] != prm.se || id[1] != ckId())
+    {
+        wrn += "checkpoint " + prm.ckp + " does not fit, not resumed; ";
+        return false;
+    }
+    b.resize(prm.sz*itms);
+    if (!ckR(img, at, &it0, 1) || !ckR(img, at, &v0, 1) || !ckR(img, at, b.data(), itms)
+        || !ckR(img, at, vs.data(), prm.sz))
+    {
+        wrn += "checkpoint " + prm.ckp + " is truncated, not resumed; ";
+        return false;
+    }
+    for (j = 0; j < itms; j++)
+        sol[j] = b[j];
+    if (!ckR(img, at, b.data(), prm.sz*itms) || !ckR(img, at, ys.data(), prm.sz*itms))
+    {
+        wrn += "checkpoint " + prm.ckp + " is truncated, not resumed; ";
+        return false;
+    }
+    for (j = 0; j < prm.sz*itms; j++)
+        xt[j] = b[j];
+    it = it0;
+    v_sol = v0;
+    rnd.s = id[2];
+    return true;
+}
+
+template<typename W>
+void MdKPQ::algI()
+/* Initialisation of the main algorithm, W = weight storage type of the prepared view:
+ * ys = particle positions (probabilities of a zero),
+ * xs = sampled solutions,
+ * xt = best solution of each particle,
+ * vs = value of the best solution of each particle,
+ * yh = position of the incumbent solution,
+ * the state at the end of an iteration (ys, xt, vs, sol, v_sol, it and rnd) is all that is checkpointed, a resumed
+ * run skips the initialisation and continues exactly as the run that was stopped.
+*/
 {
-    tm_pt t0;
-    double t, ys[S_MX][N_MX], yt[S_MX][N_MX], yh[N_MX];
-    int xs[S_MX][N_MX], xt[S_MX][N_MX], vs[S_MX], i, j, it;
-    bet = 1 - alp;
-    ep3 = 1 - ep1 - ep2;
+    double t, *y;
+    int *x, i, j, sz;
+    bool wrm, rsm;
+    sz = prm.sz;
+    bet = 1 - prm.alp;
+    ep3 = 1 - prm.ep1 - prm.ep2;
     v_sol = -INT_MAX;
-    for (i = 0; i < sz; i++)
+    ys.resize(sz*itms);
+    yh.resize(itms);
+    xs.resize(sz*itms);
+    xt.resize(sz*itms);
+    vs.resize(sz);
+    wrm = (int)prm.wsol.size() == itms;
+    it = 0;
+    rsm = prm.rsm && prm.ckp != "" && ckLd();
+    for (i = 0; i < sz && !rsm; i++)
     {
+        y = &ys[i*itms];
+        x = &xs[i*itms];
+        if (pf)
+            pf->bgn(PRF_UPD);
         for (j = 0; j < itms; j++)
         {
-            t = rndDbl();
-            ys[i][j] = t;
-            xs[i][j] = t < rndDbl() ? 1 : 0;
+            t = rnd.rndDbl();
+            if (wrm)
+            {
+                // warm start: particle 0 is the previous solution, the others are sampled around it
+                yh[j] = prm.wsol[prp->idx[j]] == 1 ? prm.alp : bet;
+                if (i == 0)
+                    t = yh[j];
+                else
+                    t = prm.ep1*t + (1 - prm.ep1)*yh[j];
+            }
+            y[j] = t;
+            if (wrm && i == 0)
+                x[j] = prm.wsol[prp->idx[j]] == 1 ? 1 : 0;
+            else
+                x[j] = t < rnd.rndDbl() ? 1 : 0;
         }
+        if (pf)
+            pf->end();
         vs[i] = -INT_MAX;
-        algS(xs[i], xt[i], vs[i]);
+        algS<W>(x, &xt[i*itms], vs[i]);
     }
-    it = 0;
-    while (it < mx)
+}
+
+template<typename W>
+void MdKPQ::algK(int mxi)
+/* Iterations of the main algorithm until mxi are done or stop() (see algI). */
+{
+    double t, yt, *y;
+    int *x, *xb, i, j, sz;
+    sz = prm.sz;
+    while (it < mxi && !stop())
     {
         for (j = 0; j < itms; j++)
-            yh[j] = alp*sol[j] + bet*(1 - sol[j]);
+            yh[j] = prm.alp*sol[j] + bet*(1 - sol[j]);
         for (i = 0; i < sz; i++)
         {
+            y = &ys[i*itms];
+            x = &xs[i*itms];
+            xb = &xt[i*itms];
+            if (pf)
+                pf->bgn(PRF_UPD);
             for (j = 0; j < itms; j++)
             {
-                yt[i][j] = alp*xt[i][j] + bet*(1 - xt[i][j]);
-                t = ep1*ys[i][j] + ep2*yt[i][j] + ep3*yh[j];
-                ys[i][j] = t;
-                xs[i][j] = t < rndDbl() ? 1 : 0;
+                yt = prm.alp*xb[j] + bet*(1 - xb[j]);
+                t = prm.ep1*y[j] + prm.ep2*yt + ep3*yh[j];
+                y[j] = t;
+                x[j] = t < rnd.rndDbl() ? 1 : 0;
             }
-            algS(xs[i], xt[i], vs[i]);
+            if (pf)
+                pf->end();
+            algS<W>(x, xb, vs[i]);
+        }
+        if (el)
+        {
+            if (prm.prw == 0)
+                el->one();
+            el->get(sol, v_sol);
         }
         it++;
+        if (prg)
+            prg(it, v_sol);
+        if (ckw && prm.cki > 0 && it % prm.cki == 0)
+            ckSv();
     }
 }
 
-void MdKPQ::info()
+template<typename W>
+void MdKPQ::alg(bool ini0, int mxi)
+/* Main algorithm: initialisation (if ini0) then iterations until mxi are done. */
 {
-    cout << name() << endl;
+    if (ini0)
+        algI<W>();
+    algK<W>(mxi);
+}
+
+void MdKPQ::alg(bool ini0, int mxi)
+/* Runs the main algorithm with the kernels for the weight storage (sparse or dense width) chosen by the prepared
+ * view.
+*/
+{
+    if (prp->spr)
+        alg<Spr>(ini0, mxi);
+    else if (prp->wb == 1)
+        alg<uint8_t>(ini0, mxi);
+    else if (prp->wb == 2)
+        alg<uint16_t>(ini0, mxi);
+    else
+        alg<int>(ini0, mxi);
 }
 
-void MdKPQ::ini(int sz0, int mx0, double alp0, double ep10, double ep20, bool out, int sty0, bool nwl0)
+void MdKPQ::ini(const Prm &prm0)
 /* Initialise. */
 {
-    sz = sz0;
-    mx = mx0;
-    alp = alp0;
-    ep1 = ep10;
-    ep2 = ep20;
-    sty = sty0;
-    nwl = nwl0;
-    if (out)
-        cout << "sz = " << sz << ", mx = " << mx << ", alp = " << alp << ", ep1 = " << ep1 << ", ep2 = " << ep2 << endl;
+    prm = prm0;
+    if (prm.sz > S_MX)
+        prm.sz = S_MX;
 }
 
-int MdKPQ::slv(MdKP &src, bool out)
-/* Initialises and solves a problem. */
+int MdKPQ::varIdx(int j)
+/* Source index of variable j. */
 {
-    tm_pt t0, t1;
-    t0 = timer::now();
-    prep(src);
-    alg();
+    return prp->idx[j];
+}
+
+int MdKPQ::invIdx(int j)
+/* Variable index of source item j. */
+{
+    return prp->inv[j];
+}
+
+bool MdKPQ::stt(MdKPS src0, Res &res)
+/* Starts a solve: prepares the view and initialises the swarm, fills res and returns false on error. */
+{
+    tm_pt t1;
+    MdKPVS prp0;
+    bool ok;
+    err = "";
+    wrn = "";
+    stp = STP_MX;
+    it = 0;
+    rnd.srnd(prm.se);
+    prp0 = prp;
+    res.x.clear();
+    pf.reset();
+    if (prm.prf)
+        pf = make_shared<Prf>();
+    if (pf)
+        pf->bgn(PRF_PRP);
+    ok = prep(src0);
+    if (pf)
+        pf->end();
+    if (pf && pf->err != "")
+        wrn += pf->err + "; ";
+    res.nwp = ok && prp != prp0;
     t1 = timer::now();
-    tm = calcMs(duration(t1 - t0));
-    if (out)
+    res.tmp = calcMs(t1 - t0);
+    if (!ok)
+    {
+        pf.reset();
+        res.v = 0;
+        res.stp = STP_ERR;
+        res.it = 0;
+        res.tm = res.tmp;
+        res.nrl = 0;
+        res.nim = 0;
+        res.err = err;
+        res.wrn = wrn;
+        return false;
+    }
+    el.reset();
+    if (prm.elt > 0)
+        el = make_shared<Elt>(prm.elt, itms, prm.edh, rlf());
+    alg(true, 0);
+    return true;
+}
+
+void MdKPQ::itr(int mxi)
+/* Iterates until mxi iterations are done (or stop()), with checkpoints if prm.ckp is set and the path relinking
+ * workers running alongside if prm.prw > 0.
+*/
+{
+    if (prm.ckp != "")
+        ckw = make_shared<Ckp>(prm.ckp);
+    if (el && prm.prw > 0)
+        el->bgn(prm.prw);
+    alg(false, mxi);
+    if (el)
+    {
+        el->cls();
+        el->get(sol, v_sol);
+    }
+    if (ckw)
     {
-        cout << "z = " << v_sol << (v_sol == opt ? " (opt)" : "") << ", tm = " << tm << " ms" << endl;
-        outSol();
+        ckSv();
+        ckw->cls();
+        if (ckw->err != "")
+            wrn += ckw->err + "; ";
+        ckw.reset();
     }
-    return v_sol;
+}
+
+void MdKPQ::fin(Res &res)
+/* Fills the result of a solve (or of a slice of one) with the incumbent and the times from t0. */
+{
+    res.v = v_sol;
+    srcSol(res.x);
+    res.stp = stp;
+    res.it = it;
+    res.tm = calcMs(timer::now() - t0);
+    res.lps = prp->lps;
+    if (pf)
+        res.prf = pf->st;
+    res.nrl = el ? el->nrl : 0;
+    res.nim = el ? el->nim : 0;
+    res.err = "";
+    res.wrn = wrn;
+}
+
+Res MdKPQ::slv(MdKPS src0, PrgCb prg0, CncCb cnc0)
+/* Initialises and solves a problem, with no output:
+ * prg0 = progress callback, called after each iteration with the iteration and incumbent value,
+ * cnc0 = cancellation callback, checked once per iteration.
+*/
+{
+    Res res;
+    t0 = timer::now();
+    prg = prg0;
+    cnc = cnc0;
+    if (!stt(src0, res))
+        return res;
+    itr((int)prm.wsol.size() == itms ? prm.wmx : prm.mx);
+    fin(res);
+    pf.reset();
+    el.reset();
+    return res;
+}
+
+Res MdKPQ::bgn(MdKPS src0)
+/* Starts a solve in slices: prepares the view and initialises the swarm without iterating, the solve goes on with
+ * cnt, Res.tm and Res.tmp are the start up times.
+*/
+{
+    Res res;
+    t0 = timer::now();
+    prg = nullptr;
+    cnc = nullptr;
+    if (stt(src0, res))
+        fin(res);
+    return res;
+}
+
+Res MdKPQ::cnt(int k, PrgCb prg0, CncCb cnc0)
+/* Continues a solve started by bgn for k more iterations (prm.tl then limits the slice), Res.it is the total of
+ * the iterations done and Res.tm the time of the slice.
+*/
+{
+    Res res;
+    t0 = timer::now();
+    prg = prg0;
+    cnc = cnc0;
+    stp = STP_MX;
+    wrn = "";
+    res.nwp = false;
+    res.tmp = 0;
+    itr(it + k);
+    fin(res);
+    return res;
 }
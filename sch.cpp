@@ -0,0 +1,328 @@
+/* CPU budget scheduler: every instance of a directory gets a solver that runs in work units of k iterations
+ * (MdKPQ::bgn then MdKPQ::cnt), the units are handed out in rounds until the wall clock budget is spent or every
+ * gap is closed. Each round grants the open instances SCH_UPR*thr units in proportion to their priority, the
+ * relative gap to the LP bound (or to the optimum if known) times SCH_IMP if the incumbent improved in the last
+ * round, so easy instances stop taking time that hard ones need. The units of an instance in a round run back to
+ * back as one task, the tasks are dealt out to per thread deques (the task of a started instance to the thread that
+ * holds its solver) and a thread whose deque is empty steals from the others.
+*/
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <iomanip>
+#include <algorithm>
+#include <dirent.h>
+#include "aff.h"
+#include "sch.h"
+
+struct SIns
+/* An instance being scheduled:
+ * fn = file name,
+ * mdkp = problem,
+ * sq = solver, made by the thread that starts the instance (after it is pinned) so that its state is placed on
+ * that thread's node by first touch,
+ * hw = home thread, the one that started the instance, its units are dealt to it (others may steal them),
+ * res = result of the last unit,
+ * bnd = upper bound (optimum if known, else the LP bound rounded down),
+ * v0 = incumbent value at the start of the round,
+ * tm = time used (ms),
+ * us = units run,
+ * q = units granted this round,
+ * imp = true if the incumbent improved in the last round,
+ * on = true while the instance is open (started and its gap not closed).
+*/
+{
+    string fn;
+    MdKPS mdkp;
+    shared_ptr<MdKPQ> sq;
+    Res res;
+    int hw, bnd, v0, us, q;
+    double tm;
+    bool imp, on;
+};
+
+class WsQ
+/* Per thread deques of tasks (instance numbers) with stealing, the threads stay up between rounds:
+ * dq = deque of each thread,
+ * mtx = mutex of each deque,
+ * m, cv, dn = mutex and conditions of the start and the end of a round,
+ * rd = round number (a change starts a round),
+ * act = number of threads busy in the round,
+ * end = true when the threads are to stop.
+*/
+{
+public:
+    vector<deque<int> > dq;
+    vector<mutex> mtx;
+    mutex m;
+    condition_variable cv, dn;
+    int rd, act;
+    bool end;
+    WsQ(int thr);
+    void put(int w, int t);
+    bool get(int w, int &t);
+    bool wt(int &r);
+    void don();
+    void run();
+};
+
+WsQ::WsQ(int thr): dq(thr), mtx(thr)
+{
+    rd = 0;
+    act = 0;
+    end = false;
+}
+
+bool WsQ::wt(int &r)
+/* Waits for the round after round r, returns false when the threads are to stop. */
+{
+    unique_lock<mutex> lck(m);
+    cv.wait(lck, [&]{return end || rd != r;});
+    r = rd;
+    return !end;
+}
+
+void WsQ::don()
+/* Reports that a thread has no more tasks in the round. */
+{
+    lock_guard<mutex> lck(m);
+    if (--act == 0)
+        dn.notify_all();
+}
+
+void WsQ::run()
+/* Starts a round on the tasks put and waits until they are all done. */
+{
+    unique_lock<mutex> lck(m);
+    act = dq.size();
+    rd++;
+    cv.notify_all();
+    dn.wait(lck, [this]{return act == 0;});
+}
+
+void WsQ::put(int w, int t)
+/* Adds a task to the deque of thread w. */
+{
+    lock_guard<mutex> lck(mtx[w]);
+    dq[w].push_back(t);
+}
+
+bool WsQ::get(int w, int &t)
+/* Takes a task, from the back of the own deque or else from the front of another, returns false if none is left. */
+{
+    int i, o;
+    {
+        lock_guard<mutex> lck(mtx[w]);
+        if (dq[w].size() > 0)
+        {
+            t = dq[w].back();
+            dq[w].pop_back();
+            return true;
+        }
+    }
+    for (i = 1; i < (int)dq.size(); i++)
+    {
+        o = (w + i) % dq.size();
+        lock_guard<mutex> lck(mtx[o]);
+        if (dq[o].size() > 0)
+        {
+            t = dq[o].front();
+            dq[o].pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+SPrm::SPrm()
+/* Default parameters. */
+{
+    bud = DEFA_SBUD;
+    k = DEFA_SK;
+    thr = 1;
+    aff = AFF_NON;
+}
+
+double gap(const SIns &si)
+/* Returns the relative gap of an instance, -1 if there is no bound. */
+{
+    if (si.bnd <= 0)
+        return -1;
+    return max(0.0, (double)(si.bnd - si.res.v)/si.bnd);
+}
+
+bool opn(const SIns &si)
+/* Returns true if an instance is still to be solved (no error, and its gap is open or unknown). */
+{
+    return si.res.stp != STP_ERR && (gap(si) < 0 || gap(si) > SCH_GAP);
+}
+
+double pri(const SIns &si)
+/* Returns the priority of an open instance: 1 before it starts, else the gap (1 if unknown) times SCH_IMP if it
+ * improved in the last round.
+*/
+{
+    if (si.us == 0)
+        return 1;
+    return (gap(si) < 0 ? 1 : gap(si))*(si.imp ? SCH_IMP : 1);
+}
+
+void unit(SIns &si, int w, const Prm &prm, int q, int k, tm_pt tend)
+/* Runs q units of an instance on thread w (the first makes the solver and starts the solve), stopping at the end
+ * of the budget.
+*/
+{
+    CncCb cnc;
+    tm_pt t;
+    int u;
+    cnc = [tend]{return timer::now() >= tend;};
+    for (u = 0; u < q && timer::now() < tend; u++)
+    {
+        t = timer::now();
+        if (si.us == 0)
+        {
+            si.hw = w;
+            si.sq = make_shared<MdKPQ>();
+            si.sq->ini(prm);
+            si.res = si.sq->bgn(si.mdkp);
+            if (si.res.stp != STP_ERR)
+                si.bnd = si.mdkp->opt > 0 ? si.mdkp->opt : (int)floor(si.res.lps.z + SCH_GAP);
+        }
+        else
+            si.res = si.sq->cnt(k, nullptr, cnc);
+        si.tm += calcMsD(timer::now() - t);
+        si.us++;
+        if (!opn(si))
+            break;
+    }
+}
+
+bool sch(const SPrm &sp, string &err)
+/* Schedules the solves of the instances in a directory within the budget and outputs the time used and the
+ * final gap of each.
+*/
+{
+    vector<string> fls;
+    vector<SIns> ins;
+    vector<thread> wks;
+    DIR *dir;
+    dirent *pdir;
+    MdKPS mdkp;
+    Prm prm;
+    tm_pt t0, tend;
+    string str;
+    double sum;
+    int i, w, thr, rds, nu;
+    dir = opendir(sp.dn.c_str());
+    if (dir == NULL)
+    {
+        err = "bad directory";
+        return false;
+    }
+    while ((pdir = readdir(dir)) != NULL)
+    {
+        str = pdir->d_name;
+        if (str != "." && str != ".." && str != "README.txt")
+            fls.push_back(str);
+    }
+    closedir(dir);
+    sort(fls.begin(), fls.end());
+    prm = sp.prm;
+    prm.tl = 0;
+    prm.ckp = "";
+    ins.resize(fls.size());
+    for (i = 0; i < (int)fls.size(); i++)
+    {
+        ins[i].fn = fls[i];
+        ins[i].mdkp = ldPrb(sp.dn + "/" + fls[i], str);
+        ins[i].hw = 0;
+        ins[i].us = 0;
+        ins[i].tm = 0;
+        ins[i].bnd = 0;
+        ins[i].imp = true;
+        ins[i].on = ins[i].mdkp != nullptr;
+        ins[i].res.v = 0;
+        if (!ins[i].on)
+            cout << str << endl;
+    }
+    thr = max(1, sp.thr);
+    WsQ wq(thr);
+    Aff af(sp.aff, false);
+    for (w = 0; w < thr; w++)
+        wks.push_back(thread([&, w]()
+        {
+            int t, r;
+            r = 0;
+            af.pin(w);
+            while (wq.wt(r))
+            {
+                while (wq.get(w, t))
+                    unit(ins[t], w, prm, ins[t].q, sp.k, tend);
+                wq.don();
+            }
+        }));
+    t0 = timer::now();
+    tend = t0 + millisecs(sp.bud);
+    rds = 0;
+    while (timer::now() < tend)
+    {
+        sum = 0;
+        for (i = 0; i < (int)ins.size(); i++)
+            if (ins[i].on)
+                sum += pri(ins[i]);
+        if (sum <= 0)
+            break;
+        w = 0;
+        for (i = 0; i < (int)ins.size(); i++)
+            if (ins[i].on)
+            {
+                ins[i].q = max(1, (int)round(SCH_UPR*thr*pri(ins[i])/sum));
+                ins[i].v0 = ins[i].res.v;
+                if (ins[i].us > 0)
+                    wq.put(ins[i].hw, i);
+                else
+                {
+                    wq.put(w, i);
+                    w = (w + 1) % thr;
+                }
+            }
+        wq.run();
+        for (i = 0; i < (int)ins.size(); i++)
+            if (ins[i].on)
+            {
+                ins[i].imp = ins[i].res.v > ins[i].v0;
+                ins[i].on = opn(ins[i]);
+                if (ins[i].res.stp == STP_ERR)
+                    cout << ins[i].fn << ": " << ins[i].res.err << endl;
+            }
+        rds++;
+    }
+    {
+        lock_guard<mutex> lck(wq.m);
+        wq.end = true;
+    }
+    wq.cv.notify_all();
+    for (w = 0; w < thr; w++)
+        wks[w].join();
+    cout << fixed << setprecision(SCH_PREC);
+    cout << "budget = " << sp.bud << " ms, used = " << calcMsD(timer::now() - t0) << " ms, thr = " << thr
+        << ", k = " << sp.k << ", rounds = " << rds << endl;
+    nu = 0;
+    for (i = 0; i < (int)ins.size(); i++)
+        if (ins[i].mdkp != nullptr && ins[i].res.stp != STP_ERR)
+        {
+            cout << ins[i].fn << ": z = " << ins[i].res.v << ", bnd = " << ins[i].bnd << ", gap = ";
+            if (gap(ins[i]) < 0)
+                cout << "unknown";
+            else
+                cout << 100*gap(ins[i]) << " %";
+            cout << ", tm = " << ins[i].tm << " ms, it = " << ins[i].res.it << ", units = " << ins[i].us << endl;
+            nu += ins[i].us;
+        }
+    cout << "units = " << nu << endl;
+    return true;
+}
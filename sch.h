@@ -0,0 +1,27 @@
+#include "mdkp.h"
+
+#define SCH_UPR 4
+#define SCH_IMP 4.0
+#define SCH_GAP 1e-6
+#define SCH_PREC 2
+
+#define DEFA_SBUD 10000
+#define DEFA_SK 20
+
+struct SPrm
+/* Scheduler parameters:
+ * dn = instance directory,
+ * prm = solver parameters (prm.mx and prm.tl are not used, prm.se seeds every instance),
+ * bud = wall clock budget for the whole directory (ms),
+ * k = iterations per work unit,
+ * thr = number of threads (cores),
+ * aff = placement policy of the threads (AFF_NON, AFF_CMP or AFF_SCT).
+*/
+{
+    string dn;
+    Prm prm;
+    int bud, k, thr, aff;
+    SPrm();
+};
+
+bool sch(const SPrm &sp, string &err);
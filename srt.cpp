@@ -1,45 +1,165 @@
+#include <algorithm>
+#include <thread>
 #include "srt.h"
 
-int prt(int idx[], double val[], int lo, int up)
-/* Partition for quick sort:
- * idx = index array,
- * val = value array,
- * lo = lower index,
- * up = upper index.
-*/
-{
-	int i, k, t;
-	double a;
-	i = lo;
-	a = val[idx[up]];
-	for (k = lo; k < up; k++)
-	{
-		t = idx[k];
-		if (val[t] > a)
-		{
-			idx[k] = idx[i];
-			idx[i++] = t;
-		}
-	}
-	t = idx[i];
-	idx[i] = idx[up];
-	idx[up] = t;
-	return i;
-}
-
-void qSrt(int idx[], double val[], int lo, int up)
-/* Quick sort algorithm. Sorts by value in reverse order.
- * idx = index array,
- * val = value array,
- * lo = lower index,
- * up = upper index.
-*/
-{
-	int p;
-	if (lo < up)
-	{
-		p = prt(idx, val, lo, up);
-		qSrt(idx, val, lo, p - 1);
-		qSrt(idx, val, p + 1, up);
-	}
+using namespace std;
+
+static bool bef(const SrtE &a, const SrtE &b)
+/* True if a sorts before b. */
+{
+    return a.k < b.k || (a.k == b.k && a.i < b.i);
+}
+
+static void insSrt(SrtE e[], int lo, int up)
+/* Insertion sort for short ranges. */
+{
+    int j, k;
+    SrtE t;
+    for (j = lo + 1; j <= up; j++)
+    {
+        t = e[j];
+        for (k = j; k > lo && bef(t, e[k - 1]); k--)
+            e[k] = e[k - 1];
+        e[k] = t;
+    }
+}
+
+static void intSrt(SrtE e[], int lo, int up, int dpth)
+/* Introsort: quick sort with a median of three pivot, switching to heap sort when the depth limit is reached,
+ * recurses on the smaller part only so the stack depth is O(log n):
+ * e = elements,
+ * lo = lower index,
+ * up = upper index,
+ * dpth = remaining depth.
+*/
+{
+    int i, k, md;
+    SrtE p;
+    while (up - lo + 1 > SRT_INS)
+    {
+        if (dpth-- == 0)
+        {
+            make_heap(e + lo, e + up + 1, bef);
+            sort_heap(e + lo, e + up + 1, bef);
+            return;
+        }
+        md = lo + (up - lo)/2;
+        if (bef(e[md], e[lo]))
+            swap(e[md], e[lo]);
+        if (bef(e[up], e[lo]))
+            swap(e[up], e[lo]);
+        if (bef(e[up], e[md]))
+            swap(e[up], e[md]);
+        p = e[md];
+        i = lo;
+        k = up;
+        while (i <= k)
+        {
+            while (bef(e[i], p))
+                i++;
+            while (bef(p, e[k]))
+                k--;
+            if (i <= k)
+                swap(e[i++], e[k--]);
+        }
+        if (k - lo < up - i)
+        {
+            intSrt(e, lo, k, dpth);
+            lo = i;
+        }
+        else
+        {
+            intSrt(e, i, up, dpth);
+            up = k;
+        }
+    }
+    insSrt(e, lo, up);
+}
+
+static void rdxSrt(SrtE e[], SrtE t[], int n)
+/* LSD radix sort on the keys, 8 bits per pass, skipping passes where every key has the same digit. The sort is
+ * stable so ties keep their (increasing index) order:
+ * e = elements,
+ * t = temporary array of the same size.
+*/
+{
+    int cnt[256], d, j, s, c;
+    SrtE *a, *b;
+    a = e;
+    b = t;
+    for (d = 0; d < 64; d += 8)
+    {
+        fill(cnt, cnt + 256, 0);
+        for (j = 0; j < n; j++)
+            cnt[(a[j].k >> d) & 0xff]++;
+        if (cnt[(a[0].k >> d) & 0xff] == n)
+            continue;
+        s = 0;
+        for (j = 0; j < 256; j++)
+        {
+            c = cnt[j];
+            cnt[j] = s;
+            s += c;
+        }
+        for (j = 0; j < n; j++)
+            b[cnt[(a[j].k >> d) & 0xff]++] = a[j];
+        swap(a, b);
+    }
+    if (a != e)
+        copy(a, a + n, e);
+}
+
+static void srtR(SrtE e[], SrtE t[], int n)
+/* Sorts a range with radix sort (long ranges) or introsort (short ranges). */
+{
+    int dpth, m;
+    if (n >= SRT_RDX)
+        rdxSrt(e, t, n);
+    else if (n > 1)
+    {
+        dpth = 0;
+        for (m = n; m > 1; m >>= 1)
+            dpth += 2;
+        intSrt(e, 0, n - 1, dpth);
+    }
+}
+
+void srtE(vector<SrtE> &e, int thr)
+/* Sorts elements by key then index, splitting large arrays into chunks sorted by separate threads and merged:
+ * e = elements,
+ * thr = maximum number of threads.
+*/
+{
+    vector<SrtE> t(e.size());
+    vector<thread> ths;
+    vector<int> bnd;
+    int n, c, j, w;
+    n = e.size();
+    if (thr > n/SRT_PAR)
+        thr = n/SRT_PAR;
+    if (thr <= 1)
+    {
+        srtR(e.data(), t.data(), n);
+        return;
+    }
+    for (c = 0; c <= thr; c++)
+        bnd.push_back((int)((long long)n*c/thr));
+    for (c = 0; c < thr; c++)
+        ths.push_back(thread(srtR, e.data() + bnd[c], t.data() + bnd[c], bnd[c + 1] - bnd[c]));
+    for (c = 0; c < thr; c++)
+        ths[c].join();
+    for (w = 1; w < thr; w *= 2)
+    {
+        ths.clear();
+        for (c = 0; c + w < thr; c += 2*w)
+        {
+            j = min(c + 2*w, thr);
+            ths.push_back(thread([&e, &bnd, c, w, j]()
+            {
+                inplace_merge(e.begin() + bnd[c], e.begin() + bnd[c + w], e.begin() + bnd[j], bef);
+            }));
+        }
+        for (c = 0; c < (int)ths.size(); c++)
+            ths[c].join();
+    }
 }
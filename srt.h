@@ -1,2 +1,58 @@
-int prt(int idx[], double val[], int lo, int up);
-void qSrt(int idx[], double val[], int lo, int up);
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define SRT_INS 16
+#define SRT_RDX 2048
+#define SRT_PAR 65536
+
+struct SrtE
+/* Sort element: k = ordered key, i = index (breaks ties). */
+{
+    uint64_t k;
+    int i;
+};
+
+void srtE(std::vector<SrtE> &e, int thr);
+
+inline uint64_t srtKey(double d)
+/* Maps a double to an unsigned key with the same order (negative values have all bits flipped). */
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return (u >> 63) ? ~u : u | (1ull << 63);
+}
+
+inline uint64_t srtKey(int64_t x)
+/* Maps a signed integer to an unsigned key with the same order. */
+{
+    return (uint64_t)x ^ (1ull << 63);
+}
+
+inline uint64_t srtKey(int x)
+{
+    return srtKey((int64_t)x);
+}
+
+template<typename K>
+void idxSrt(int idx[], const K key[], int n, bool dsc, int thr = 1)
+/* Index sort, fills idx with 0 .. n - 1 ordered by key (decreasing if dsc) with ties in increasing index order,
+ * so the result does not depend on the algorithm or the number of threads:
+ * idx = index array (output),
+ * key = key array,
+ * n = number of keys,
+ * dsc = true for decreasing order,
+ * thr = maximum number of threads (used only for large n).
+*/
+{
+    std::vector<SrtE> e(n);
+    int j;
+    for (j = 0; j < n; j++)
+    {
+        e[j].k = dsc ? ~srtKey(key[j]) : srtKey(key[j]);
+        e[j].i = j;
+    }
+    srtE(e, thr);
+    for (j = 0; j < n; j++)
+        idx[j] = e[j].i;
+}
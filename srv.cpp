@@ -0,0 +1,345 @@
+/* Solve server: reads jobs, one per line, from stdin or from the connections to a Unix domain socket, solves
+ * them on a pool of worker threads and writes a result line for each job as soon as it is ready.
+ *
+ * Requests:
+ * <id> inp <path> = solve the problem in a data file,
+ * <id> prb <data> = solve the problem given inline in the data file format (on one line),
+ * stats = report the number of jobs queued and done and the mean latency.
+ *
+ * Results:
+ * id = <id>, z = <value>, tm = <solve ms>, lat = <ms from request to result>, qd = <queue depth>, stp = <reason>,
+ * sol = <numbers of the selected items>
+ * or id = <id>, err = <message>.
+*/
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include "aff.h"
+#include "srv.h"
+
+class Conn
+/* A client connection, results are written to fd, closed when the last job referring to it is done:
+ * fd = file descriptor (output),
+ * own = true if fd is closed by the connection,
+ * bad = true once a write has failed (the client has gone), later results are dropped,
+ * mtx = serialises writes.
+*/
+{
+public:
+    int fd;
+    bool own, bad;
+    mutex mtx;
+    Conn(int fd0, bool own0);
+    ~Conn();
+    void wr(const string &ln);
+};
+
+struct Job
+/* A queued job:
+ * id = client job identifier,
+ * cmd = command (inp or prb),
+ * arg = rest of the request line,
+ * t0 = time the request was read,
+ * cn = connection the result is written to.
+*/
+{
+    string id, cmd, arg;
+    tm_pt t0;
+    shared_ptr<Conn> cn;
+};
+
+class Srv
+/* Job queue and worker pool:
+ * prm = solver parameters for every job,
+ * q = job queue,
+ * mtx, cv = queue lock and signal,
+ * end = set when no more jobs will be queued,
+ * ndn = jobs done,
+ * lat = total latency of the jobs done (ms),
+ * af = placement of the workers.
+*/
+{
+public:
+    Prm prm;
+    deque<Job> q;
+    mutex mtx;
+    condition_variable cv;
+    bool end;
+    long ndn;
+    double lat;
+    Aff af;
+    Srv(const Prm &prm0, int aff);
+    void wrk(int w);
+    void rd(shared_ptr<Conn> cn, istream &is);
+    void rdFd(shared_ptr<Conn> cn);
+    void req(shared_ptr<Conn> cn, const string &ln);
+    string stats();
+};
+
+Conn::Conn(int fd0, bool own0)
+{
+    fd = fd0;
+    own = own0;
+    bad = false;
+}
+
+Conn::~Conn()
+{
+    if (own)
+        close(fd);
+}
+
+void Conn::wr(const string &ln)
+/* Writes a line in one piece, on a failed write (EPIPE if the client has gone) the connection is shut down so its
+ * reader ends too.
+*/
+{
+    string s;
+    size_t k;
+    ssize_t n;
+    s = ln + "\n";
+    lock_guard<mutex> lck(mtx);
+    if (bad)
+        return;
+    for (k = 0; k < s.size(); k += n)
+    {
+        n = write(fd, s.data() + k, s.size() - k);
+        if (n < 0 && errno == EINTR)
+            n = 0;
+        else if (n <= 0)
+        {
+            bad = true;
+            if (own)
+                shutdown(fd, SHUT_RDWR);
+            return;
+        }
+    }
+}
+
+Srv::Srv(const Prm &prm0, int aff): af(aff, false)
+{
+    prm = prm0;
+    prm.ckp = "";
+    end = false;
+    ndn = 0;
+    lat = 0;
+}
+
+void Srv::wrk(int w)
+/* Worker w: takes jobs from the queue until it is empty and ended, the solver (and its buffers) is reused and is
+ * made after the worker is pinned.
+*/
+{
+    MdKPS prb;
+    Res res;
+    ostringstream os;
+    istringstream is;
+    string err;
+    double l;
+    int j, qd;
+    bool aft;
+    af.pin(w);
+    MdKPQ mdkpq;
+    mdkpq.ini(prm);
+    while (true)
+    {
+        // a job holds its connection open so it is scoped to one iteration
+        Job job;
+        {
+            unique_lock<mutex> lck(mtx);
+            cv.wait(lck, [this]() { return end || !q.empty(); });
+            if (q.empty())
+                return;
+            job = q.front();
+            q.pop_front();
+        }
+        if (job.cmd == "inp")
+            prb = ldPrb(job.arg, err);
+        else
+        {
+            is.clear();
+            is.str(job.arg);
+            prb = ldPrb(is, "job " + job.id, err);
+        }
+        os.str("");
+        os << fixed << setprecision(2) << "id = " << job.id;
+        if (prb != nullptr)
+        {
+            res = mdkpq.slv(prb);
+            if (res.stp == STP_ERR)
+                err = res.err;
+        }
+        if (prb == nullptr || res.stp == STP_ERR)
+        {
+            os << ", err = " << err;
+            job.cn->wr(os.str());
+            continue;
+        }
+        l = calcMsD(timer::now() - job.t0);
+        {
+            lock_guard<mutex> lck(mtx);
+            ndn++;
+            lat += l;
+            qd = q.size();
+        }
+        os << ", z = " << res.v << ", tm = " << res.tm << ", lat = " << l << ", qd = " << qd << ", stp = "
+            << stpName(res.stp) << ", sol =";
+        aft = false;
+        for (j = 0; j < (int)res.x.size(); j++)
+            if (res.x[j] == 1)
+            {
+                os << (aft ? ", " : " ") << j + 1;
+                aft = true;
+            }
+        job.cn->wr(os.str());
+    }
+}
+
+string Srv::stats()
+/* Returns the queue depth, jobs done and mean latency. */
+{
+    ostringstream os;
+    lock_guard<mutex> lck(mtx);
+    os << fixed << setprecision(2) << "qd = " << q.size() << ", dn = " << ndn << ", alat = "
+        << (ndn > 0 ? lat/ndn : 0) << " ms";
+    return os.str();
+}
+
+void Srv::req(shared_ptr<Conn> cn, const string &ln)
+/* Handles a request line. */
+{
+    istringstream is(ln);
+    Job job;
+    job.t0 = timer::now();
+    if (!(is >> job.id))
+        return;
+    if (job.id == "stats")
+    {
+        cn->wr(stats());
+        return;
+    }
+    if (!(is >> job.cmd) || (job.cmd != "inp" && job.cmd != "prb"))
+    {
+        cn->wr("id = " + job.id + ", err = bad request");
+        return;
+    }
+    getline(is >> ws, job.arg);
+    job.cn = cn;
+    {
+        lock_guard<mutex> lck(mtx);
+        q.push_back(job);
+    }
+    cv.notify_one();
+}
+
+void Srv::rd(shared_ptr<Conn> cn, istream &is)
+/* Reads request lines from a stream. */
+{
+    string ln;
+    while (getline(is, ln))
+        req(cn, ln);
+}
+
+void Srv::rdFd(shared_ptr<Conn> cn)
+/* Reads request lines from a socket connection. */
+{
+    char buf[SRV_BUF];
+    string ln;
+    ssize_t n, k;
+    while ((n = read(cn->fd, buf, sizeof(buf))) > 0)
+        for (k = 0; k < n; k++)
+            if (buf[k] == '\n')
+            {
+                req(cn, ln);
+                ln.clear();
+            }
+            else
+                ln += buf[k];
+    if (ln != "")
+        req(cn, ln);
+}
+
+bool srv(string adr, const Prm &prm, int thr, int aff)
+/* Runs the server:
+ * adr = Unix domain socket path, or SRV_STDIN for requests on stdin and results on stdout,
+ * prm = solver parameters,
+ * thr = number of worker threads,
+ * aff = placement policy of the workers (AFF_NON, AFF_CMP or AFF_SCT),
+ * the connection readers are detached and share sv, so it outlives this function while one is still reading,
+ * returns false if the socket cannot be listened on (a file at adr that is not a socket is left alone).
+*/
+{
+    shared_ptr<Srv> sv;
+    vector<thread> wks;
+    sockaddr_un sa;
+    struct stat st;
+    int i, fd, cfd;
+    bool ok;
+    if (thr < 1)
+        thr = 1;
+    sv = make_shared<Srv>(prm, aff);
+    // a client that goes before its results are written must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    for (i = 0; i < thr; i++)
+        wks.push_back(thread(&Srv::wrk, sv.get(), i));
+    ok = true;
+    if (adr == SRV_STDIN)
+        sv->rd(make_shared<Conn>(STDOUT_FILENO, false), cin);
+    else
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        if (fd < 0 || adr.size() >= sizeof(sa.sun_path))
+        {
+            cout << "bad socket " << adr << endl;
+            ok = false;
+        }
+        else
+        {
+            strcpy(sa.sun_path, adr.c_str());
+            // only a stale socket is removed, never another kind of file at the path
+            if (lstat(adr.c_str(), &st) == 0 && !S_ISSOCK(st.st_mode))
+            {
+                cout << "cannot listen on " << adr << ": not a socket" << endl;
+                ok = false;
+            }
+            else if (unlink(adr.c_str()) != 0 && errno != ENOENT)
+            {
+                cout << "cannot listen on " << adr << ": " << strerror(errno) << endl;
+                ok = false;
+            }
+            else if (bind(fd, (sockaddr *)&sa, sizeof(sa)) != 0 || listen(fd, SRV_BKLG) != 0)
+            {
+                cout << "cannot listen on " << adr << ": " << strerror(errno) << endl;
+                ok = false;
+            }
+            else
+            {
+                cout << "listening on " << adr << ", thr = " << thr << endl;
+                while ((cfd = accept(fd, NULL, NULL)) >= 0)
+                    thread([sv, cfd]() { sv->rdFd(make_shared<Conn>(cfd, true)); }).detach();
+            }
+            close(fd);
+        }
+    }
+    {
+        lock_guard<mutex> lck(sv->mtx);
+        sv->end = true;
+    }
+    sv->cv.notify_all();
+    for (i = 0; i < thr; i++)
+        wks[i].join();
+    return ok;
+}
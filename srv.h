@@ -0,0 +1,7 @@
+#include "mdkp.h"
+
+#define SRV_STDIN "-"
+#define SRV_BKLG 16
+#define SRV_BUF 65536
+
+bool srv(string adr, const Prm &prm, int thr, int aff);
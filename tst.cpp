@@ -0,0 +1,85 @@
+/* Checks of the solver (Test target), exits with 1 if one fails. */
+
+#include <algorithm>
+#include "mdkp.h"
+#include "tune.h"
+
+#define TST_N 200
+#define TST_M 20
+#define TST_NZ 2
+
+MdKPS tstPrb(uint64_t se, int wlo, int wup)
+/* Makes a sparse instance, each item has TST_NZ nonzero weights in [wlo, wup] (zero weights drawn are made 1). */
+{
+    shared_ptr<MdKP> prb;
+    vector<int> val(TST_N), wei(TST_M*TST_N, 0), cap(TST_M);
+    Rng rnd(se);
+    int i, j, k, w;
+    for (j = 0; j < TST_N; j++)
+    {
+        val[j] = rnd.rndU(1, 100);
+        for (k = 0; k < TST_NZ; k++)
+        {
+            i = rnd.rndU(0, TST_M - 1);
+            w = rnd.rndU(wlo, wup);
+            wei[i*TST_N + j] = w != 0 ? w : 1;
+        }
+    }
+    for (i = 0; i < TST_M; i++)
+        cap[i] = rnd.rndU(20, 60);
+    prb = make_shared<MdKP>();
+    prb->mkPrb(TST_N, TST_M, val.data(), wei.data(), cap.data(), 0);
+    return prb;
+}
+
+bool tstFeas(string nm, MdKPS prb, bool spr)
+/* Solves a problem and checks the kernels chosen (spr) and that the best solution is feasible with its value. */
+{
+    MdKPQ mdkpq;
+    Prm prm;
+    Res res;
+    bool ok;
+    prm.mx = 50;
+    mdkpq.ini(prm);
+    res = mdkpq.slv(prb);
+    ok = res.stp != STP_ERR && mdkpq.prp->spr == spr && prb->feasSol(res.x.data())
+        && res.v == prb->vSol(res.x.data());
+    cout << nm << ": spr = " << mdkpq.prp->spr << ", z = " << res.v << (ok ? ", ok" : ", FAILED") << endl;
+    return ok;
+}
+
+bool tstRace(string nm, const vector<vector<int> > &vs, int exp)
+/* Races candidates with the values vs (one vector per stage, TUN_MNS stages so that the only drop is at the last
+ * stage) and checks that the winner is a survivor and is candidate exp.
+*/
+{
+    vector<vector<int> > z;
+    vector<int> alv;
+    int c, s;
+    bool ok;
+    for (c = 0; c < (int)vs[0].size(); c++)
+        alv.push_back(c);
+    for (s = 0; s < (int)vs.size(); s++)
+    {
+        z.push_back(vs[s]);
+        drop(z, alv);
+    }
+    c = bstCd(z, alv);
+    ok = find(alv.begin(), alv.end(), c) != alv.end() && c == exp;
+    cout << nm << ": left = " << alv.size() << ", best = " << c << (ok ? ", ok" : ", FAILED") << endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok;
+    ok = tstFeas("sparse, non-negative weights", tstPrb(1, 1, 30), true);
+    // the overuse counts of the sparse kernels need non-negative weights, so mixed signs must take the dense path
+    ok = tstFeas("sparse, mixed sign weights", tstPrb(2, -30, 30), false) && ok;
+    ok = tstRace("race, drop at the last stage", vector<vector<int> >(TUN_MNS, {40, 30, 20, 10}), 0) && ok;
+    ok = tstRace("race, 4 to 2 at the last stage", {{40, 39, 20, 10}, {39, 40, 10, 20}, {40, 39, 20, 10},
+        {39, 40, 10, 20}, {40, 39, 20, 10}}, 0) && ok;
+    ok = tstRace("race, 3 tied to the last stage", vector<vector<int> >(TUN_MNS, {10, 10, 10}), 0) && ok;
+    ok = tstRace("race, 3 mixed to the last stage", {{5, 9, 7}, {6, 9, 7}, {9, 8, 7}, {5, 9, 8}, {6, 9, 9}}, 1) && ok;
+    return ok ? 0 : 1;
+}
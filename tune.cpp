@@ -0,0 +1,297 @@
+/* Parameter racing (F-Race, Birattari et al. 2002): the candidate configurations of sz, alp, ep1 and ep2 are run
+ * on the instances of a family one stage at a time, every run with the same time budget, so mx is replaced by
+ * whatever number of iterations a configuration manages in the budget. After TUN_MNS stages the results are
+ * ranked per stage and, when the Friedman test finds a difference, the candidates whose rank sum is worse than the
+ * best by more than the Conover post hoc critical difference are dropped. The race ends when one candidate is left
+ * or after mxs stages. The runs of a stage are shared out between threads, each thread has its own solver (made
+ * after the thread is pinned) and the prepared views are shared between them.
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <iomanip>
+#include "aff.h"
+#include "tune.h"
+
+TPrm::TPrm()
+/* Default parameters. */
+{
+    nc = DEFA_TNC;
+    tl = DEFA_TTL;
+    mxs = DEFA_TMS;
+    thr = 1;
+    aff = AFF_NON;
+    rpl = false;
+}
+
+bool lsDir(string dn, vector<string> &fls, vector<string> &dirs)
+/* Lists the files and the subdirectories of a directory (sorted). */
+{
+    DIR *dir;
+    dirent *pdir;
+    struct stat st;
+    string str;
+    dir = opendir(dn.c_str());
+    if (dir == NULL)
+        return false;
+    while ((pdir = readdir(dir)) != NULL)
+    {
+        str = pdir->d_name;
+        if (str == "." || str == ".." || str == "README.txt" || stat((dn + "/" + str).c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+            dirs.push_back(str);
+        else
+            fls.push_back(str);
+    }
+    closedir(dir);
+    sort(fls.begin(), fls.end());
+    sort(dirs.begin(), dirs.end());
+    return true;
+}
+
+void rnkStg(const vector<int> &z, const vector<int> &alv, vector<double> &r)
+/* Ranks the surviving candidates of a stage, 1 for the best (highest) value, ties share the mean rank:
+ * z = values of all candidates,
+ * alv = surviving candidates,
+ * r = ranks (output, one per surviving candidate).
+*/
+{
+    vector<int> o(alv.size());
+    int a, b, c, k;
+    k = alv.size();
+    for (a = 0; a < k; a++)
+        o[a] = a;
+    sort(o.begin(), o.end(), [&](int p, int q){return z[alv[p]] > z[alv[q]] || (z[alv[p]] == z[alv[q]] && p < q);});
+    r.assign(k, 0);
+    for (a = 0; a < k; a = b)
+    {
+        for (b = a + 1; b < k && z[alv[o[b]]] == z[alv[o[a]]]; b++);
+        for (c = a; c < b; c++)
+            r[o[c]] = (a + b + 1)/2.0;
+    }
+}
+
+double rnkSm(const vector<vector<int> > &z, const vector<int> &alv, vector<double> &rs)
+/* Rank sums of the surviving candidates over the stages done, returns the sum of the squared ranks:
+ * z = values of all candidates, one vector per stage,
+ * alv = surviving candidates,
+ * rs = rank sums (output, one per surviving candidate).
+*/
+{
+    vector<double> r;
+    double a2;
+    int k, i, s;
+    k = alv.size();
+    rs.assign(k, 0);
+    a2 = 0;
+    for (s = 0; s < (int)z.size(); s++)
+    {
+        rnkStg(z[s], alv, r);
+        for (i = 0; i < k; i++)
+        {
+            rs[i] += r[i];
+            a2 += r[i]*r[i];
+        }
+    }
+    return a2;
+}
+
+int bstCd(const vector<vector<int> > &z, const vector<int> &alv)
+/* Returns the surviving candidate with the best (lowest) rank sum. */
+{
+    vector<double> rs;
+    rnkSm(z, alv, rs);
+    return alv[min_element(rs.begin(), rs.end()) - rs.begin()];
+}
+
+bool drop(const vector<vector<int> > &z, vector<int> &alv)
+/* Friedman test over the stages done, then drops the candidates worse than the best by more than the critical
+ * difference:
+ * z = values of all candidates, one vector per stage,
+ * alv = surviving candidates (updated),
+ * returns true if any candidate was dropped.
+*/
+{
+    vector<double> rs;
+    vector<int> nalv;
+    double a2, c, t, df, chi, cd, bst;
+    int b, k, i;
+    b = z.size();
+    k = alv.size();
+    a2 = rnkSm(z, alv, rs);
+    c = b*k*(k + 1)*(k + 1)/4.0;
+    if (k < 2 || b < TUN_MNS || a2 - c <= 0)
+        return false;
+    t = 0;
+    for (i = 0; i < k; i++)
+        t += (rs[i] - b*(k + 1)/2.0)*(rs[i] - b*(k + 1)/2.0);
+    t *= (k - 1)/(a2 - c);
+    df = k - 1;
+    chi = df*pow(1 - 2/(9*df) + TUN_Z95*sqrt(2/(9*df)), 3);
+    if (t <= chi)
+        return false;
+    df = (b - 1)*(k - 1);
+    cd = (TUN_Z975 + (pow(TUN_Z975, 3) + TUN_Z975)/(4*df))
+        *sqrt(2*b*(a2 - c)/df*max(0.0, 1 - t/(b*(k - 1))));
+    bst = *min_element(rs.begin(), rs.end());
+    for (i = 0; i < k; i++)
+        if (rs[i] - bst <= cd)
+            nalv.push_back(alv[i]);
+    if ((int)nalv.size() == k)
+        return false;
+    alv = nalv;
+    return true;
+}
+
+bool race(const TPrm &tp, string fam, string dn, const vector<Prm> &cds)
+/* Races the candidates on the instances in a directory and outputs the best configuration:
+ * fam = family name,
+ * cds = candidate configurations.
+*/
+{
+    vector<string> fls, dirs;
+    vector<MdKPS> prbs;
+    vector<MdKPVS> pvs;
+    vector<vector<int> > z;
+    vector<long long> its(cds.size(), 0);
+    vector<int> alv;
+    vector<thread> wks;
+    atomic<int> nxt;
+    MdKPS mdkp;
+    MdKPQ pq;
+    Prm p0;
+    Rng rng;
+    string err;
+    uint64_t se;
+    int c, s, i, b, k, thr;
+    if (!lsDir(dn, fls, dirs))
+    {
+        cout << "bad directory " << dn << endl;
+        return false;
+    }
+    for (i = 0; i < (int)fls.size(); i++)
+    {
+        mdkp = ldPrb(dn + "/" + fls[i], err);
+        if (mdkp == nullptr)
+            cout << err << endl;
+        else
+            prbs.push_back(mdkp);
+    }
+    if (prbs.size() == 0)
+    {
+        cout << "no instances in " << dn << endl;
+        return false;
+    }
+    p0 = tp.prm;
+    p0.mx = 0;
+    pq.ini(p0);
+    for (i = 0; i < (int)prbs.size(); i++)
+    {
+        pq.slv(prbs[i]);
+        pvs.push_back(pq.prp);
+    }
+    for (c = 0; c < (int)cds.size(); c++)
+        alv.push_back(c);
+    rng.srnd(tp.prm.se);
+    Aff af(tp.aff, tp.rpl);
+    for (s = 0; s < tp.mxs && alv.size() > 1; s++)
+    {
+        i = s % prbs.size();
+        se = rng.nxt();
+        z.push_back(vector<int>(cds.size(), 0));
+        nxt = 0;
+        k = alv.size();
+        thr = max(1, min(tp.thr, k));
+        wks.clear();
+        for (b = 0; b < thr; b++)
+            wks.push_back(thread([&, b]()
+            {
+                Prm p;
+                Res res;
+                MdKPVS pv;
+                int a, c0;
+                af.pin(b);
+                // made after the pin so that the swarm state is placed on the node of the thread
+                MdKPQ sq;
+                pv = af.rep(b, pvs[i]);
+                while ((a = nxt++) < k)
+                {
+                    c0 = alv[a];
+                    p = cds[c0];
+                    p.se = se;
+                    sq.ini(p);
+                    sq.prp = pv;
+                    res = sq.slv(prbs[i]);
+                    z[s][c0] = res.v;
+                    its[c0] += res.it;
+                }
+            }));
+        for (b = 0; b < thr; b++)
+            wks[b].join();
+        if (drop(z, alv))
+            cout << "family " << fam << ", stage " << s + 1 << ", " << alv.size() << " left" << endl;
+    }
+    c = bstCd(z, alv);
+    cout << "family " << fam << ": stages = " << s << ", left = " << alv.size() << ", best = " << c + 1 << endl;
+    cout << "sz = " << cds[c].sz << ", mx = " << (s > 0 ? its[c]/s : 0) << ", alp = " << cds[c].alp << ", ep1 = "
+        << cds[c].ep1 << ", ep2 = " << cds[c].ep2 << " (tl = " << tp.tl << " ms)" << endl;
+    return true;
+}
+
+bool tune(const TPrm &tp, string &err)
+/* Draws the candidate configurations (the first is tp.prm) and races them on each family. */
+{
+    vector<string> fls, dirs;
+    vector<Prm> cds;
+    Prm p;
+    Rng rng;
+    int c, f;
+    bool ok;
+    if (tp.nc < 1 || tp.tl < 1 || tp.mxs < 1)
+    {
+        err = "bad racing parameters";
+        return false;
+    }
+    if (!lsDir(tp.dn, fls, dirs))
+    {
+        err = "bad directory";
+        return false;
+    }
+    rng.srnd(tp.prm.se);
+    rng.nxt();
+    for (c = 0; c < tp.nc; c++)
+    {
+        p = tp.prm;
+        p.tl = tp.tl;
+        p.mx = TUN_MX;
+        p.wsol.clear();
+        p.wbas = "";
+        p.sbas = "";
+        p.ckp = "";
+        p.rsm = false;
+        if (c > 0)
+        {
+            p.sz = rng.rndU(TUN_SZL, S_MX);
+            p.alp = TUN_ALPL + (TUN_ALPU - TUN_ALPL)*rng.rndDbl();
+            p.ep1 = TUN_EP1L + (TUN_EP1U - TUN_EP1L)*rng.rndDbl();
+            p.ep2 = TUN_EP2L + (min(TUN_EP2U, 1 - p.ep1) - TUN_EP2L)*rng.rndDbl();
+        }
+        cds.push_back(p);
+    }
+    cout << fixed << setprecision(2);
+    cout << "racing " << tp.nc << " configurations, tl = " << tp.tl << " ms, thr = " << tp.thr << endl;
+    ok = true;
+    if (dirs.size() == 0)
+        ok = race(tp, tp.dn, tp.dn, cds);
+    else
+        for (f = 0; f < (int)dirs.size(); f++)
+            ok = race(tp, dirs[f], tp.dn + "/" + dirs[f], cds) && ok;
+    if (!ok)
+        err = "racing failed";
+    return ok;
+}
@@ -0,0 +1,41 @@
+#include "mdkp.h"
+
+#define TUN_SZL 5
+#define TUN_ALPL 0.01
+#define TUN_ALPU 0.5
+#define TUN_EP1L 0.1
+#define TUN_EP1U 0.8
+#define TUN_EP2L 0.05
+#define TUN_EP2U 0.5
+#define TUN_MX 1000000000
+#define TUN_MNS 5
+#define TUN_Z95 1.6449
+#define TUN_Z975 1.96
+
+#define DEFA_TNC 16
+#define DEFA_TTL 100
+#define DEFA_TMS 60
+
+struct TPrm
+/* Parameter racing parameters:
+ * dn = training directory, each subdirectory is a family of instances raced separately (the directory itself is
+ * the only family if it has no subdirectories),
+ * prm = base parameters, the first candidate, prm.se seeds the candidates and the runs, prm.lpm is used by all,
+ * nc = number of candidate configurations,
+ * tl = time budget of each run (ms), the same for every candidate,
+ * mxs = maximum number of stages (a stage runs every surviving candidate on one instance),
+ * thr = number of threads,
+ * aff = placement policy of the threads (AFF_NON, AFF_CMP or AFF_SCT),
+ * rpl = true to give each node its own copy of the prepared instances.
+*/
+{
+    string dn;
+    Prm prm;
+    int nc, tl, mxs, thr, aff;
+    bool rpl;
+    TPrm();
+};
+
+bool drop(const vector<vector<int> > &z, vector<int> &alv);
+int bstCd(const vector<vector<int> > &z, const vector<int> &alv);
+bool tune(const TPrm &tp, string &err);